@@ -0,0 +1,244 @@
+// Reader of the columnar binary files written with '--binaryOutput=1' by wifi-central-controlled-aggregation_v215.cc
+// (_KPIs.col, _AMPDUvalues.col, _positions.col). It does not need ns3.
+//
+// The file is mapped in memory, so the values of a column in a block can be used directly as an array:
+//
+//   ColumnarReader reader;
+//   if (!reader.Open ("test_KPIs.col")) ...
+//   for (uint32_t b = 0; b < reader.GetNumberBlocks (); b++) {
+//     const double* delay = reader.GetDoubles (b, reader.FindColumn ("delay [s]"));
+//     for (uint32_t r = 0; r < reader.GetRows (b); r++) ... delay[r] ...
+//   }
+//
+// The layout is described in the .cc file, next to the class RowWriter
+
+#ifndef COLUMNAR_READER_H
+#define COLUMNAR_READER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class ColumnarReader
+{
+  public:
+    struct column {
+      char type;      // 'd' double, 'u' uint32, 'e' uint8 (index of a label)
+      bool nullable;
+      std::string name;
+      std::string nullText;
+      std::vector<std::string> labels;
+    };
+
+    ColumnarReader ();
+    ~ColumnarReader ();
+    bool Open (std::string fileName);  // if there is an error, it is printed and 'false' is returned
+    void Close ();
+
+    uint32_t GetNumberColumns () const { return columns.size (); }
+    bool HasTrailingTab () const { return trailingTab; }  // the text version of the file ends each line with a tab
+    const column& GetColumn (uint32_t i) const { return columns[i]; }
+    int32_t FindColumn (std::string name) const;  // the first column with this name, or -1
+
+    uint32_t GetNumberBlocks () const { return blocks.size (); }
+    uint32_t GetRows (uint32_t block) const { return blocks[block].rows; }
+    const double* GetDoubles (uint32_t block, uint32_t i) const { return (const double*) blocks[block].values[i]; }
+    const uint32_t* GetUints (uint32_t block, uint32_t i) const { return (const uint32_t*) blocks[block].values[i]; }
+    const uint8_t* GetEnums (uint32_t block, uint32_t i) const { return (const uint8_t*) blocks[block].values[i]; }
+
+    bool IsNull (uint32_t block, uint32_t i, uint32_t row) const;
+
+    // the value as it is written in the text files (default formatting of the streams)
+    void PrintValue (std::ostream& os, uint32_t block, uint32_t i, uint32_t row) const;
+
+  private:
+    struct block {
+      uint32_t rows;
+      std::vector<const char*> values;  // start of each column
+    };
+    bool ReadText (const char** position, const char* end, std::string* text);
+    static uint32_t Padded (uint64_t size) { return (size + 7) / 8 * 8; }
+    static uint32_t ValueSize (char type) { return type == 'd' ? 8 : (type == 'u' ? 4 : 1); }
+
+    const char* data;
+    size_t size;
+    bool trailingTab;
+    std::vector<column> columns;
+    std::vector<block> blocks;
+};
+
+inline
+ColumnarReader::ColumnarReader ()
+{
+  data = NULL;
+  size = 0;
+  trailingTab = false;
+}
+
+inline
+ColumnarReader::~ColumnarReader ()
+{
+  Close ();
+}
+
+inline void
+ColumnarReader::Close ()
+{
+  if (data != NULL)
+    munmap ((void*) data, size);
+  data = NULL;
+  size = 0;
+  trailingTab = false;
+  columns.clear ();
+  blocks.clear ();
+}
+
+inline bool
+ColumnarReader::ReadText (const char** position, const char* end, std::string* text)
+{
+  uint16_t length;
+  if (*position + sizeof (length) > end)
+    return false;
+  length = *(const uint16_t*) *position;
+  *position += sizeof (length);
+  if (*position + length > end)
+    return false;
+  text->assign (*position, length);
+  *position += length;
+  return true;
+}
+
+inline bool
+ColumnarReader::Open (std::string fileName)
+{
+  Close ();
+
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "ERROR: cannot open " << fileName << "\n";
+    return false;
+  }
+  struct stat fileStatus;
+  fstat (fd, &fileStatus);
+  size = fileStatus.st_size;
+  if (size < 24) {
+    std::cerr << "ERROR: " << fileName << " is not a columnar file\n";
+    close (fd);
+    return false;
+  }
+  data = (const char*) mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "ERROR: cannot map " << fileName << "\n";
+    data = NULL;
+    return false;
+  }
+
+  if (std::string (data, 8) != "WSSCOL02") {
+    std::cerr << "ERROR: " << fileName << " is not a columnar file\n";
+    Close ();
+    return false;
+  }
+  uint32_t numberColumns = *(const uint32_t*) (data + 8);
+  uint32_t descriptionSize = *(const uint32_t*) (data + 12);
+  uint32_t flags = *(const uint32_t*) (data + 16);
+  trailingTab = (flags & 1) != 0;
+  const char* position = data + 24;
+  const char* end = position + descriptionSize;
+  if (end > data + size) {
+    std::cerr << "ERROR: " << fileName << " is truncated\n";
+    Close ();
+    return false;
+  }
+
+  // description of the columns
+  for (uint32_t i = 0; i < numberColumns; i++) {
+    column thisColumn;
+    if (position + 4 > end) {
+      std::cerr << "ERROR: wrong description of the columns in " << fileName << "\n";
+      Close ();
+      return false;
+    }
+    thisColumn.type = position[0];
+    thisColumn.nullable = (position[1] != 0);
+    uint16_t numberLabels = *(const uint16_t*) (position + 2);
+    position += 4;
+    bool correct = ReadText (&position, end, &thisColumn.name) && ReadText (&position, end, &thisColumn.nullText);
+    for (uint16_t j = 0; correct && (j < numberLabels); j++) {
+      std::string label;
+      correct = ReadText (&position, end, &label);
+      thisColumn.labels.push_back (label);
+    }
+    if (!correct || ( (thisColumn.type != 'd') && (thisColumn.type != 'u') && (thisColumn.type != 'e') ) ) {
+      std::cerr << "ERROR: wrong description of the columns in " << fileName << "\n";
+      Close ();
+      return false;
+    }
+    columns.push_back (thisColumn);
+  }
+
+  // blocks. A block that has not been completely written (e.g. the simulation was interrupted) is ignored
+  position = end;
+  while (position + 8 <= data + size) {
+    block thisBlock;
+    thisBlock.rows = *(const uint32_t*) position;
+    position += 8;
+    for (uint32_t i = 0; i < columns.size (); i++) {
+      thisBlock.values.push_back (position);
+      position += Padded ((uint64_t) thisBlock.rows * ValueSize (columns[i].type));
+    }
+    if (position > data + size) {
+      std::cerr << "WARNING: the last block of " << fileName << " is incomplete. It is ignored\n";
+      break;
+    }
+    blocks.push_back (thisBlock);
+  }
+  return true;
+}
+
+inline int32_t
+ColumnarReader::FindColumn (std::string name) const
+{
+  for (uint32_t i = 0; i < columns.size (); i++)
+    if (columns[i].name == name)
+      return i;
+  return -1;
+}
+
+inline bool
+ColumnarReader::IsNull (uint32_t block, uint32_t i, uint32_t row) const
+{
+  if (!columns[i].nullable)
+    return false;
+  if (columns[i].type == 'd')
+    return std::isnan (GetDoubles (block, i)[row]);
+  if (columns[i].type == 'u')
+    return GetUints (block, i)[row] == 0xFFFFFFFF;
+  return false;
+}
+
+inline void
+ColumnarReader::PrintValue (std::ostream& os, uint32_t block, uint32_t i, uint32_t row) const
+{
+  if (IsNull (block, i, row))
+    os << columns[i].nullText;
+  else if (columns[i].type == 'd')
+    os << GetDoubles (block, i)[row];
+  else if (columns[i].type == 'u')
+    os << GetUints (block, i)[row];
+  else {
+    uint8_t label = GetEnums (block, i)[row];
+    if (label < columns[i].labels.size ())
+      os << columns[i].labels[label];
+    else
+      os << (uint32_t) label;
+  }
+}
+
+#endif
@@ -0,0 +1,46 @@
+// Convert the columnar binary files written with '--binaryOutput=1' (_KPIs.col, _AMPDUvalues.col, _positions.col)
+// to the tab-separated text format of the '.txt' files. It does not need ns3:
+//
+//   g++ -O2 -o columnar-to-tsv columnar-to-tsv.cc
+//   ./columnar-to-tsv test_KPIs.col > test_KPIs.txt
+//
+// If several files are given, they are written one after the other, with the titles of the columns only once
+
+#include "columnar-reader.h"
+#include <iostream>
+
+int main (int argc, char *argv[])
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.col> [<file.col> ...]\n";
+    return 1;
+  }
+
+  for (int f = 1; f < argc; f++) {
+    ColumnarReader reader;
+    if (!reader.Open (argv[f]))
+      return 1;
+
+    // the lines of some files (e.g. _positions) also have a tab after the last value
+    bool trailingTab = reader.HasTrailingTab ();
+
+    // the first line includes the titles of the columns
+    if (f == 1) {
+      for (uint32_t i = 0; i < reader.GetNumberColumns (); i++)
+        std::cout << reader.GetColumn (i).name << ( (i + 1 < reader.GetNumberColumns ()) || trailingTab ? "\t" : "");
+      std::cout << "\n";
+    }
+
+    for (uint32_t b = 0; b < reader.GetNumberBlocks (); b++) {
+      for (uint32_t row = 0; row < reader.GetRows (b); row++) {
+        for (uint32_t i = 0; i < reader.GetNumberColumns (); i++) {
+          reader.PrintValue (std::cout, b, i, row);
+          if ( (i + 1 < reader.GetNumberColumns ()) || trailingTab )
+            std::cout << "\t";
+        }
+        std::cout << "\n";
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,289 @@
+// Merge the results of the runs written with '--resultsFolder' by wifi-central-controlled-aggregation_v215.cc
+// (a file '<surname>.res' per run). For each point of the sweep and each metric, it writes the number of runs,
+// the mean, the standard deviation and the half-width of the 95% confidence interval. It does not need ns3:
+//
+//   g++ -O2 -pthread -o merge-results merge-results.cc
+//   ./merge-results -j 8 results/ > summary.txt
+//
+// The files are read by several threads (-j), one file at a time, and only the sums of each point are kept in
+// memory, so the number of files is not limited by the memory. Both folders and files can be given.
+//
+// With -l, it writes instead a line per run, with the format of '_average.txt', ordered by surname
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// number of samples, mean and sum of the squares of the differences to the mean (Welford)
+struct accumulator {
+  uint64_t n;
+  double mean;
+  double m2;
+  accumulator () : n (0), mean (0.0), m2 (0.0) {}
+
+  void Add (double value)
+  {
+    n++;
+    double delta = value - mean;
+    mean += delta / n;
+    m2 += delta * (value - mean);
+  }
+
+  // add the samples of another accumulator (Chan et al.)
+  void Merge (const accumulator& other)
+  {
+    if (other.n == 0)
+      return;
+    uint64_t total = n + other.n;
+    double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * ((double) n * other.n / total);
+    n = total;
+  }
+};
+
+// the metrics of a point, in the order of the columns of the first file in which they appear
+struct point {
+  std::vector<std::string> names;
+  std::map<std::string, accumulator> metrics;
+
+  accumulator& Get (const std::string& name)
+  {
+    std::map<std::string, accumulator>::iterator it = metrics.find (name);
+    if (it != metrics.end ())
+      return it->second;
+    names.push_back (name);
+    return metrics[name];
+  }
+};
+
+typedef std::map<std::string, point> pointMap;
+
+// what each thread has read
+struct partialResult {
+  pointMap points;
+  std::vector<std::pair<std::string, std::string> > lines;  // surname, line of '_average.txt' (only with -l)
+  uint64_t files;
+  uint64_t errors;
+  partialResult () : files (0), errors (0) {}
+};
+
+// the first columns of a file are not metrics
+static bool
+IsKey (const std::string& name)
+{
+  return (name == "point") || (name == "surname") || (name == "RngRun");
+}
+
+static void
+Split (const std::string& line, std::vector<std::string>* fields)
+{
+  fields->clear ();
+  size_t start = 0;
+  while (true) {
+    size_t end = line.find ('\t', start);
+    if (end == std::string::npos) {
+      fields->push_back (line.substr (start));
+      return;
+    }
+    fields->push_back (line.substr (start, end - start));
+    start = end + 1;
+  }
+}
+
+// read a file and add its values. If there is an error, it is printed and 'false' is returned
+static bool
+ReadFile (const std::string& fileName, bool averageLines, partialResult* result)
+{
+  std::ifstream ifs (fileName.c_str ());
+  std::string header, values;
+  if (!std::getline (ifs, header) || !std::getline (ifs, values)) {
+    std::cerr << "ERROR: " << fileName << " is not a results file\n";
+    return false;
+  }
+  std::vector<std::string> names, fields;
+  Split (header, &names);
+  Split (values, &fields);
+  if ((names.size () != fields.size ()) || (names.size () < 3) || (names[0] != "point") || (names[1] != "surname")) {
+    std::cerr << "ERROR: wrong columns in " << fileName << "\n";
+    return false;
+  }
+
+  if (averageLines) {
+    std::string line = fields[1];
+    for (uint32_t i = 0; i < names.size (); i++) {
+      if (!IsKey (names[i])) {
+        // the values are written again with the default precision, as in '_average.txt'
+        std::ostringstream value;
+        if (!fields[i].empty ())
+          value << strtod (fields[i].c_str (), NULL);
+        line += "\t" + names[i] + "\t" + value.str ();
+      }
+    }
+    result->lines.push_back (std::make_pair (fields[1], line));
+    return true;
+  }
+
+  point& thisPoint = result->points[fields[0]];
+  for (uint32_t i = 0; i < names.size (); i++) {
+    if (IsKey (names[i]))
+      continue;
+    accumulator& thisMetric = thisPoint.Get (names[i]);
+    if (fields[i].empty ())
+      continue;   // the metric has not been obtained in this run
+    char* end;
+    double value = strtod (fields[i].c_str (), &end);
+    if (*end != '\0') {
+      std::cerr << "ERROR: wrong value of '" << names[i] << "' in " << fileName << "\n";
+      return false;
+    }
+    thisMetric.Add (value);
+  }
+  return true;
+}
+
+// the files of the arguments: the '.res' files of each folder, and the files themselves
+static void
+ListFiles (int argc, char *argv[], int first, std::vector<std::string>* files)
+{
+  for (int i = first; i < argc; i++) {
+    struct stat status;
+    if ((stat (argv[i], &status) == 0) && S_ISDIR (status.st_mode)) {
+      DIR* dir = opendir (argv[i]);
+      if (dir == NULL) {
+        std::cerr << "ERROR: cannot open " << argv[i] << "\n";
+        continue;
+      }
+      struct dirent* entry;
+      while ((entry = readdir (dir)) != NULL) {
+        std::string name = entry->d_name;
+        if ((name.size () > 4) && (name.compare (name.size () - 4, 4, ".res") == 0))
+          files->push_back (std::string (argv[i]) + "/" + name);
+      }
+      closedir (dir);
+    } else {
+      files->push_back (argv[i]);
+    }
+  }
+}
+
+// two-sided 95% quantile of the Student t distribution
+static double
+StudentT95 (uint64_t degreesOfFreedom)
+{
+  static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+  if (degreesOfFreedom <= 30)
+    return table[degreesOfFreedom - 1];
+  if (degreesOfFreedom <= 60)
+    return 2.000;
+  if (degreesOfFreedom <= 120)
+    return 1.980;
+  return 1.960;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t numberThreads = 1;
+  bool averageLines = false;
+  int first = 1;
+  while ((first < argc) && (argv[first][0] == '-')) {
+    if ((strcmp (argv[first], "-j") == 0) && (first + 1 < argc)) {
+      numberThreads = std::max (1, atoi (argv[first + 1]));
+      first += 2;
+    } else if (strcmp (argv[first], "-l") == 0) {
+      averageLines = true;
+      first++;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc) {
+    std::cerr << "Usage: " << argv[0] << " [-j <threads>] [-l] <folder or file.res> [...]\n";
+    return 1;
+  }
+
+  std::vector<std::string> files;
+  ListFiles (argc, argv, first, &files);
+  if (files.empty ()) {
+    std::cerr << "ERROR: no results files found\n";
+    return 1;
+  }
+
+  // each thread takes the next file that nobody has read
+  numberThreads = std::min<uint32_t> (numberThreads, files.size ());
+  std::vector<partialResult> partial (numberThreads);
+  std::atomic<size_t> next (0);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < numberThreads; t++) {
+    threads.push_back (std::thread ([&files, &partial, &next, averageLines, t] () {
+      size_t i;
+      while ((i = next.fetch_add (1)) < files.size ()) {
+        if (ReadFile (files[i], averageLines, &partial[t]))
+          partial[t].files++;
+        else
+          partial[t].errors++;
+      }
+    }));
+  }
+  for (uint32_t t = 0; t < numberThreads; t++)
+    threads[t].join ();
+
+  uint64_t errors = 0;
+  for (uint32_t t = 0; t < numberThreads; t++)
+    errors += partial[t].errors;
+
+  if (averageLines) {
+    std::vector<std::pair<std::string, std::string> > lines;
+    for (uint32_t t = 0; t < numberThreads; t++)
+      lines.insert (lines.end (), partial[t].lines.begin (), partial[t].lines.end ());
+    std::sort (lines.begin (), lines.end ());
+    for (uint32_t i = 0; i < lines.size (); i++)
+      std::cout << lines[i].second << "\n";
+    return errors > 0 ? 1 : 0;
+  }
+
+  // add the sums of all the threads
+  pointMap points;
+  for (uint32_t t = 0; t < numberThreads; t++) {
+    for (pointMap::iterator p = partial[t].points.begin (); p != partial[t].points.end (); ++p) {
+      point& thisPoint = points[p->first];
+      for (uint32_t m = 0; m < p->second.names.size (); m++)
+        thisPoint.Get (p->second.names[m]).Merge (p->second.metrics[p->second.names[m]]);
+    }
+  }
+
+  std::cout << "point\tmetric\tn\tmean\tstddev\tci95\n";
+  for (pointMap::iterator p = points.begin (); p != points.end (); ++p) {
+    for (uint32_t m = 0; m < p->second.names.size (); m++) {
+      const accumulator& thisMetric = p->second.metrics[p->second.names[m]];
+      std::cout << p->first << "\t" << p->second.names[m] << "\t" << thisMetric.n << "\t";
+      if (thisMetric.n == 0) {
+        std::cout << "\t\t\n";
+        continue;
+      }
+      std::cout << thisMetric.mean << "\t";
+      if (thisMetric.n < 2) {
+        std::cout << "\t\n";
+        continue;
+      }
+      double stddev = sqrt (thisMetric.m2 / (thisMetric.n - 1));
+      std::cout << stddev << "\t"
+                << StudentT95 (thisMetric.n - 1) * stddev / sqrt ((double) thisMetric.n) << "\n";
+    }
+  }
+  return errors > 0 ? 1 : 0;
+}
@@ -227,6 +227,8 @@ using namespace ns3;
                               // https://www.nsnam.org/doxygen/classns3_1_1_sta_wifi_mac.html
 
 #define STEPADJUSTAMPDUDEFAULT 1000  // Default value. We will update AMPDU up and down using this step size
+#define AMPDUGROWTHFACTORDEFAULT 2.0  // Default value. Method 3 multiplies AMPDU by this factor when the latency is below the budget
+#define AMPDUSHRINKFACTORDEFAULT 0.618  // Default value. Method 3 multiplies AMPDU by this factor when the latency is above the budget
 
 #define AGGRESSIVENESS 10     // Factor to decrease AMPDU down
 
@@ -2081,6 +2083,8 @@ struct adjustAmpduParameters {
   std::string mynameAMPDUFile;
   uint16_t methodAdjustAmpdu;
   uint32_t stepAdjustAmpdu; 
+  double ampduGrowthFactor;
+  double ampduShrinkFactor;
 };
 
 
@@ -2355,12 +2359,12 @@ void adjustAMPDU (//FlowStatistics* myFlowStatistics,
       //  if the latency is below the latency budget
       if ( highestLatencyVoIPFlows < myparam.latencyBudget ) {
         // increase the AMPDU value
-        newAmpduValue = std::min(uint32_t( currentAmpduValue * 2), myparam.maxAmpduSize);
+        newAmpduValue = std::min(uint32_t( currentAmpduValue * myparam.ampduGrowthFactor), myparam.maxAmpduSize);
 
       // if the latency is above the latency budget  
       } else {
         // decrease the AMPDU value
-        newAmpduValue = std::max(uint32_t( currentAmpduValue * 0.618 ), minimumAmpduValue); // avoid values above the maximum
+        newAmpduValue = std::max(uint32_t( currentAmpduValue * myparam.ampduShrinkFactor ), minimumAmpduValue); // avoid values above the maximum
       }
 
 
@@ -2847,6 +2851,10 @@ int main (int argc, char *argv[]) {
 
   uint32_t stepAdjustAmpdu = STEPADJUSTAMPDUDEFAULT; // step for adjusting the AMPDU size. Assign the default value
 
+  double ampduGrowthFactor = AMPDUGROWTHFACTORDEFAULT; // method 3: factor for increasing the AMPDU size. Assign the default value
+
+  double ampduShrinkFactor = AMPDUSHRINKFACTORDEFAULT; // method 3: factor for decreasing the AMPDU size. Assign the default value
+
 
   // Assign the selected value of the MAX AMPDU
   if ( (version80211 == 0) || (version80211 == 2) ) {
@@ -2910,6 +2918,8 @@ int main (int argc, char *argv[]) {
   cmd.AddValue ("latencyBudget", "Maximum latency [s] tolerated by VoIP applications", latencyBudget);
   cmd.AddValue ("methodAdjustAmpdu", "Method for adjusting AMPDU size: '0' (default), '1' ...", methodAdjustAmpdu);
   cmd.AddValue ("stepAdjustAmpdu", "Step for adjusting AMPDU size [bytes]", stepAdjustAmpdu);
+  cmd.AddValue ("ampduGrowthFactor", "Method 3: factor for increasing AMPDU size when the latency is below the budget, e.g. 2, 1.618, 2.618", ampduGrowthFactor);
+  cmd.AddValue ("ampduShrinkFactor", "Method 3: factor for decreasing AMPDU size when the latency is above the budget, e.g. 0.618, 0.381, 0.236", ampduShrinkFactor);
 
   // TCP parameters
   cmd.AddValue ("TcpPayloadSize", "Payload size [bytes]", TcpPayloadSize);
@@ -3175,6 +3185,8 @@ int main (int argc, char *argv[]) {
     std::cout << "Maximum latency tolerated by VoIP applications: " << latencyBudget << " s" << '\n';
     std::cout << "Method for adjusting AMPDU size: '0' (default), '1' PENDING: " << methodAdjustAmpdu << '\n';
     std::cout << "Step for adjusting AMPDU size: " << stepAdjustAmpdu << " bytes" << '\n';
+    std::cout << "Factor for increasing AMPDU size (method 3): " << ampduGrowthFactor << '\n';
+    std::cout << "Factor for decreasing AMPDU size (method 3): " << ampduShrinkFactor << '\n';
 
     std::cout << '\n';
     // TCP parameters
@@ -5254,6 +5266,8 @@ int main (int argc, char *argv[]) {
       myparam.mynameAMPDUFile = nameAMPDUFile.str();
       myparam.methodAdjustAmpdu = methodAdjustAmpdu;
       myparam.stepAdjustAmpdu = stepAdjustAmpdu;
+      myparam.ampduGrowthFactor = ampduGrowthFactor;
+      myparam.ampduShrinkFactor = ampduShrinkFactor;
 
       // Modify the AMPDU of the APs where there are VoIP flows
       Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL + timeMonitorKPIs + 0.0002),
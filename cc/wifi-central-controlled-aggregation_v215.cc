@@ -154,6 +154,10 @@ Two possibilities:
 // ns-3.26$ NS_GLOBAL_VALUE="RngRun=3" ./waf --run "scratch/wifi-central-controlled-aggregation --simulationTime=2 --nodeMobility=3 --verboseLevel=2 --number_of_APs=10 --number_of_APs_per_row=1"
 // you can call it with different values of RngRun to obtain different realizations
 //
+// With --replications=N, the program runs N realizations, one after the other, in the same process,
+// with RngRun, RngRun+1, ... RngRun+N-1. '_run-<RngRun>' is added to the surname of each one,
+// and all of them add their line to name_average.txt
+//
 // for being able to see the logs, do ns-3.26$ export NS_LOG=UdpEchoClientApplication=level_all
 // or /ns-3-dev$ export 'NS_LOG=ArpCache=level_all'
 // or /ns-3-dev$ export 'NS_LOG=ArpCache=level_error' for showing only errors
@@ -172,14 +176,14 @@ Two possibilities:
 //
 //    - name_average.txt                            it integrates all the tests with the same name, even if they have a different surname
 //                                                  the file is not deleted, so each test with the same name is added at the bottom
+//    - results/seed-1.res                          with --resultsFolder=results, the averages of this run are written here instead of in name_average.txt
 //    - name_seed-1_flows.txt                       information of all the flows of this run
-//    - name_seed-1_flow_1_delay_histogram.txt      delay histogram of flow #1
-//    - name_seed-1_flow_1_jitter_histogram.txt
-//    - name_seed-1_flow_1_packetsize_histogram.txt
+//    - name_seed-1_histograms.txt                  delay, jitter and packet size histograms of all the flows, and of each application
 //    - name_seed-1_KPIs.txt                        text file reporting periodically the KPIs (generated if aggregationDynamicAlgorithm==1)
 //    - name_seed-1_positions.txt                   text file reporting periodically the positions of the STAs
 //    - name_seed-1_AMPDUvalues.txt                 text file reporting periodically the AMPDU values (generated if aggregationDynamicAlgorithm==1)
 //    - name_seed-1_flowmonitor.xml
+//    - name_seed-1_profile.txt                     wall time and allocations of the callbacks of this script (generated if profileCallbacks==1)
 //    - name_seed-1_AP-0.2.pcap                     pcap file of the device 2 of AP #0
 //    - name_seed-1_server-2-1.pcap                 pcap file of the device 1 of server #2
 //    - name_seed-1_STA-8-1.pcap                    pcap file of the device 1 of STA #8
@@ -203,6 +207,23 @@ Two possibilities:
 #include "ns3/random-variable-stream.h"
 #include <sstream>
 #include <iomanip>
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <sys/resource.h>  // getrusage, for the peak memory in the benchmark
+#include <sys/wait.h>       // fork mode
+#include <sys/stat.h>       // mkdir, for the folder of the results
+#include <unistd.h>
+#include <cstdio>           // std::remove
+#include <limits>
+#include <csignal>          // the trace ring is written if the program aborts
+#include <new>              // the allocations are counted by the callback profiler
+#include <thread>           // writer thread of the output files
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 //#include "ns3/arp-cache.h"  // If you want to do things with the ARPs
 //#include "ns3/arp-header.h"
@@ -211,6 +232,53 @@ using namespace ns3;
 
 #define VERBOSE_FOR_DEBUG 0
 
+// Highest verbose level whose messages are compiled. The messages of higher levels are removed by the compiler,
+// so they do not cost anything, not even the comparison. For production runs, compile with -DLOG_LEVEL_COMPILED=0
+// In a run, the messages are shown if they are compiled and '--verboseLevel' is high enough
+#ifndef LOG_LEVEL_COMPILED
+#define LOG_LEVEL_COMPILED 4
+#endif
+#define LOG_ENABLED(level, verbose) (((level) <= LOG_LEVEL_COMPILED) && ((verbose) >= (level)))
+
+// The trace ring (--traceRingSize) can also be removed at compile time, with -DTRACE_RING_COMPILED=0
+#ifndef TRACE_RING_COMPILED
+#define TRACE_RING_COMPILED 1
+#endif
+
+// The callback profiler (--profileCallbacks) counts the memory allocations done in each callback. To do it,
+// 'new' is replaced by a version that increments a counter and calls malloc. This is only done in the builds used
+// to profile, compiled with -DPROFILE_ALLOCATIONS=1. By default the standard 'new' is kept (the profile table will
+// not include the allocations)
+#ifndef PROFILE_ALLOCATIONS
+#define PROFILE_ALLOCATIONS 0
+#endif
+
+#if PROFILE_ALLOCATIONS
+// number of allocations done by this thread (ns3 and the simulation). The callback profiler reads it before and after each callback
+static thread_local uint64_t allocationCount = 0;
+
+void*
+operator new (std::size_t size)
+{
+  allocationCount++;
+  void* pointer = malloc (size > 0 ? size : 1);
+  if (pointer == NULL)
+    throw std::bad_alloc ();
+  return pointer;
+}
+
+void*
+operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void operator delete (void* pointer) noexcept { free (pointer); }
+void operator delete[] (void* pointer) noexcept { free (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept { free (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept { free (pointer); }
+#endif
+
 // Maximum AMPDU size of 802.11n
 #define MAXSIZE80211n 65535
 
@@ -231,6 +299,8 @@ using namespace ns3;
                               // https://www.nsnam.org/doxygen/classns3_1_1_sta_wifi_mac.html
 
 #define STEPADJUSTAMPDUDEFAULT 1000  // Default value. We will update AMPDU up and down using this step size
+#define AMPDUGROWTHFACTORDEFAULT 2.0  // Default value. Method 3 multiplies AMPDU by this factor when the latency is below the budget
+#define AMPDUSHRINKFACTORDEFAULT 0.618  // Default value. Method 3 multiplies AMPDU by this factor when the latency is above the budget
 
 #define AGGRESSIVENESS 10     // Factor to decrease AMPDU down
 
@@ -273,151 +343,262 @@ static void SetPhyOn (Ptr <WifiPhy> myPhy) {
 }
 */
 
-std::string getWirelessBandOfChannel(uint8_t channel) {
-  // see https://en.wikipedia.org/wiki/List_of_WLAN_channels#2.4_GHz_(802.11b/g/n/ax)
-  if (channel <= 14 ) {
-    return "2.4 GHz";
-  }
-  else {
-    return "5 GHz";
-  }
+// Frequency bands, as a bitmask: the bands supported by a device with two cards are the OR of the bands of each card
+enum WifiBand : uint8_t {
+  BAND_NONE = 0,
+  BAND_2_4GHZ = 1,
+  BAND_5GHZ = 2,
+  BAND_BOTH = BAND_2_4GHZ | BAND_5GHZ
+};
+
+// the band is printed with the names used in the messages ("2.4 GHz", "5 GHz", "both")
+std::ostream&
+operator<< (std::ostream& os, WifiBand band)
+{
+  static const char* names[4] = { "none", "2.4 GHz", "5 GHz", "both" };
+  return os << names[band & BAND_BOTH];
 }
 
-std::string getWirelessBandOfStandard(enum ns3::WifiPhyStandard standard) {
+constexpr WifiBand getWirelessBandOfChannel(uint8_t channel) {
   // see https://en.wikipedia.org/wiki/List_of_WLAN_channels#2.4_GHz_(802.11b/g/n/ax)
-  if (standard == WIFI_PHY_STANDARD_80211a ) {
-    return "5 GHz"; // 5GHz
-  }
-  else if (standard == WIFI_PHY_STANDARD_80211b ) {
-    return "2.4 GHz";
-  }
-  else if (standard == WIFI_PHY_STANDARD_80211g ) {
-    return "2.4 GHz";
-  }
-  else if (standard == WIFI_PHY_STANDARD_80211n_2_4GHZ  ) {
-    return "2.4 GHz";
-  }
-  else if (standard == WIFI_PHY_STANDARD_80211n_5GHZ  ) {
-    return "5 GHz";
-  }
-  else if (standard == WIFI_PHY_STANDARD_80211ac ) {
-    return "5 GHz";
-  }
+  return (channel <= 14) ? BAND_2_4GHZ : BAND_5GHZ;
+}
+
+// Binary trace of the last events (associations, AMPDU changes, periodic tasks), kept in memory in a ring buffer
+// of '--traceRingSize' records. Adding an event only copies some numbers into the next record: nothing is formatted
+// and there are no locks, since only the thread of the simulator writes. The records are written as text
+// if the program aborts (e.g. a failed NS_ASSERT in a debug build), and at the end of the run if '--traceRingFile' is set
+// All the fields are integers (the time in nanoseconds), so they can be written without snprintf from the signal handler
+enum TraceEventType {
+  TRACE_ASSOC = 0,      // a: STA, b: AP
+  TRACE_DEASSOC,        // a: STA, b: AP
+  TRACE_AMPDU_AP,       // a: AP, value: new AMPDU size
+  TRACE_AMPDU_STA,      // a: STA, b: AP, value: new AMPDU size
+  TRACE_KPI,            // a: number of flows updated
+  TRACE_POSITIONS,      // a: number of STAs sampled
+  TRACE_NUMBER_TYPES
+};
 
-  // if I am here, it means I have asked for an unsupported standard (unsupported by this program so far)
-  NS_ASSERT(false);
+const char* TraceEventNames[TRACE_NUMBER_TYPES] = { "assoc", "deassoc", "ampdu_AP", "ampdu_STA", "KPIs", "positions" };
+
+class TraceRing
+{
+  public:
+    TraceRing ();
+    void SetSize (uint32_t size);
+    void Add (uint8_t type, uint32_t a, uint32_t b, uint32_t value);
+    void Dump (int fd) const;
+  private:
+    struct record {
+      int64_t time;     // nanoseconds
+      uint32_t value;
+      uint32_t a;
+      uint32_t b;
+      uint8_t type;
+    };
+    static void Append (char* line, uint32_t* length, const char* text);
+    static void AppendNumber (char* line, uint32_t* length, uint64_t value);
+    std::vector<record> records;
+    uint64_t next;    // number of events added so far
+};
+
+TraceRing::TraceRing ()
+{
+  next = 0;
 }
 
-ns3::WifiPhyStandard convertVersionToStandard (std::string my_version80211) {
-  if (my_version80211 == "11n5") {
-    return WIFI_PHY_STANDARD_80211n_5GHZ;
-  }
-  else if (my_version80211 == "11ac") {
-    return WIFI_PHY_STANDARD_80211ac;
-  }
-  else if (my_version80211 == "11n2.4") {
-    return WIFI_PHY_STANDARD_80211n_2_4GHZ;
-  }
-  else if (my_version80211 == "11g") {
-    return WIFI_PHY_STANDARD_80211g;
+void
+TraceRing::SetSize (uint32_t size)
+{
+  records.assign (size, record ());
+  next = 0;
+}
+
+inline void
+TraceRing::Add (uint8_t type, uint32_t a, uint32_t b, uint32_t value)
+{
+  if (records.empty ())
+    return;
+  record& thisRecord = records[next % records.size ()];
+  thisRecord.time = Simulator::Now ().GetNanoSeconds ();
+  thisRecord.value = value;
+  thisRecord.a = a;
+  thisRecord.b = b;
+  thisRecord.type = type;
+  next++;
+}
+
+// add a text to a line of the dump. The lines are shorter than 160 characters, since all the fields are short
+void
+TraceRing::Append (char* line, uint32_t* length, const char* text)
+{
+  while ((*text != '\0') && (*length < 159))
+    line[(*length)++] = *text++;
+}
+
+// add a number in decimal. snprintf is not used, since it is not async-signal-safe
+void
+TraceRing::AppendNumber (char* line, uint32_t* length, uint64_t value)
+{
+  char digits[24];
+  uint32_t numberDigits = 0;
+  do {
+    digits[numberDigits++] = '0' + (value % 10);
+    value /= 10;
+  } while (value > 0);
+  while ((numberDigits > 0) && (*length < 159))
+    line[(*length)++] = digits[--numberDigits];
+}
+
+// write the records, from the oldest one. It only uses write and integer arithmetic, so it can be called from a signal handler
+void
+TraceRing::Dump (int fd) const
+{
+  if (records.empty ())
+    return;
+
+  char line[160];
+  uint32_t length = 0;
+  Append (line, &length, "trace ring: last ");
+  AppendNumber (line, &length, std::min<uint64_t> (next, records.size ()));
+  Append (line, &length, " events\ntime [ns]\tevent\ta\tb\tvalue\n");
+  if (write (fd, line, length) < 0)
+    return;
+
+  uint64_t first = (next > records.size ()) ? next - records.size () : 0;
+  for (uint64_t i = first; i < next; i++) {
+    const record& thisRecord = records[i % records.size ()];
+    length = 0;
+    AppendNumber (line, &length, thisRecord.time > 0 ? thisRecord.time : 0);
+    Append (line, &length, "\t");
+    Append (line, &length, (thisRecord.type < TRACE_NUMBER_TYPES) ? TraceEventNames[thisRecord.type] : "?");
+    Append (line, &length, "\t");
+    AppendNumber (line, &length, thisRecord.a);
+    Append (line, &length, "\t");
+    AppendNumber (line, &length, thisRecord.b);
+    Append (line, &length, "\t");
+    AppendNumber (line, &length, thisRecord.value);
+    Append (line, &length, "\n");
+    if (write (fd, line, length) < 0)
+      return;
   }
-  else if (my_version80211 == "11a") {
-    return WIFI_PHY_STANDARD_80211a;
+}
+
+TraceRing traceRing;
+
+#define TRACE_EVENT(type, a, b, value) \
+  do { \
+    if (TRACE_RING_COMPILED) \
+      traceRing.Add ((type), (a), (b), (value)); \
+  } while (0)
+
+// a failed assert calls abort (): write the last events to stderr before finishing
+static void
+TraceRingAbort (int signalNumber)
+{
+  traceRing.Dump (STDERR_FILENO);
+  signal (signalNumber, SIG_DFL);
+  raise (signalNumber);
+}
+
+// Versions of 802.11 supported by this program. The option (e.g. '--version80211primary=11ac') is converted once,
+// and then the band and the ns3 standard of a version are obtained from these tables
+enum Wifi80211Version : uint8_t {
+  VERSION_11n5 = 0,
+  VERSION_11ac,
+  VERSION_11n2_4,
+  VERSION_11g,
+  VERSION_11a,
+  VERSION_NUMBER,
+  VERSION_UNKNOWN = VERSION_NUMBER
+};
+
+const char* Version80211Names[VERSION_NUMBER] = { "11n5", "11ac", "11n2.4", "11g", "11a" };
+
+constexpr WifiBand BandOfVersion[VERSION_NUMBER] = { BAND_5GHZ, BAND_5GHZ, BAND_2_4GHZ, BAND_2_4GHZ, BAND_5GHZ };
+
+const ns3::WifiPhyStandard StandardOfVersion[VERSION_NUMBER] = { WIFI_PHY_STANDARD_80211n_5GHZ,
+                                                                 WIFI_PHY_STANDARD_80211ac,
+                                                                 WIFI_PHY_STANDARD_80211n_2_4GHZ,
+                                                                 WIFI_PHY_STANDARD_80211g,
+                                                                 WIFI_PHY_STANDARD_80211a };
+
+// the version is printed with the name of the option
+std::ostream&
+operator<< (std::ostream& os, Wifi80211Version version)
+{
+  return os << ((version < VERSION_NUMBER) ? Version80211Names[version] : "unknown");
+}
+
+// returns VERSION_UNKNOWN if the name is not one of the supported versions
+Wifi80211Version convertNameToVersion (std::string my_version80211) {
+  for (uint8_t i = 0; i < VERSION_NUMBER; i++) {
+    if (my_version80211 == Version80211Names[i])
+      return Wifi80211Version (i);
   }
-  // if I am here, it means I have asked for an unsupported version (unsupported by this program so far)
-  NS_ASSERT(false);  
+  return VERSION_UNKNOWN;
+}
+
+constexpr WifiBand getWirelessBandOfVersion(Wifi80211Version version) {
+  // see https://en.wikipedia.org/wiki/List_of_WLAN_channels#2.4_GHz_(802.11b/g/n/ax)
+  return (version < VERSION_NUMBER) ? BandOfVersion[version] : BAND_NONE;
+}
+
+ns3::WifiPhyStandard convertVersionToStandard (Wifi80211Version my_version80211) {
+  // if the version is unknown, I have asked for an unsupported version (unsupported by this program so far)
+  NS_ASSERT(my_version80211 < VERSION_NUMBER);
+  return StandardOfVersion[my_version80211];
 }
 
-// returns
-// 0  both bands are supported
-// 2  2.4GHz band is supported
-// 5  5GHz band is supported
-std::string bandsSupportedBySTA(int numberWiFiCards, std::string version80211primary, std::string version80211secondary) {
+// returns the bands supported by the STA: BAND_BOTH, BAND_2_4GHZ or BAND_5GHZ
+WifiBand bandsSupportedBySTA(int numberWiFiCards, Wifi80211Version version80211primary, Wifi80211Version version80211secondary) {
   if (numberWiFiCards == 1) {
     // single WiFi card
-    return getWirelessBandOfStandard(convertVersionToStandard(version80211primary));
+    return getWirelessBandOfVersion(version80211primary);
   }
   else if (numberWiFiCards == 2) {
     // two WiFi cards
-    if (getWirelessBandOfStandard(convertVersionToStandard(version80211primary)) == "5 GHz" ) {
-      if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "2.4 GHz" ) {
-        return "both"; // both bands are supported by the STA
-      }
-      else if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "5 GHz" ) {
-        std::cout << "ERROR: both interfaces of the STA are in the same band - "
-                  << "FINISHING SIMULATION"
-                  << std::endl;
-        NS_ASSERT(false); // both interfaces of the STA are in the same band
-        return "";
-      }
-    }
-    else if (getWirelessBandOfStandard(convertVersionToStandard(version80211primary)) == "2.4 GHz" ) {
-      if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "5 GHz" ) {
-        return "both"; // both bands are supported by the STA
-      }
-      else if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "2.4 GHz" ) {
-        std::cout << "ERROR: both interfaces of the STA are in the same band - "
-                  << "FINISHING SIMULATION"
-                  << std::endl;
-        NS_ASSERT(false); // both interfaces of the STA are in the same band
-        return "";
-      }
+    if (getWirelessBandOfVersion(version80211primary) == getWirelessBandOfVersion(version80211secondary)) {
+      std::cout << "ERROR: both interfaces of the STA are in the same band - "
+                << "FINISHING SIMULATION"
+                << std::endl;
+      NS_ASSERT(false); // both interfaces of the STA are in the same band
+      return BAND_NONE;
     }
+    return WifiBand (getWirelessBandOfVersion(version80211primary) | getWirelessBandOfVersion(version80211secondary));
   }
   else {
     // only 2 wireless cards are supported so far
     NS_ASSERT(false);
-    return "";
+    return BAND_NONE;
   }
-  return "";
 }
 
 
-// returns
-// 0  both bands are supported
-// 2  2.4GHz band is supported
-// 5  5GHz band is supported
-std::string bandsSupportedByTheAPs(int numberAPsSamePlace, std::string version80211primary, std::string version80211secondary) {
+// returns the bands supported by the APs: BAND_BOTH, BAND_2_4GHZ or BAND_5GHZ
+WifiBand bandsSupportedByTheAPs(int numberAPsSamePlace, Wifi80211Version version80211primary, Wifi80211Version version80211secondary) {
   if (numberAPsSamePlace == 1) {
     // single WiFi card
-    return getWirelessBandOfStandard(convertVersionToStandard(version80211primary));
+    return getWirelessBandOfVersion(version80211primary);
   }
   else if (numberAPsSamePlace == 2) {
     // two WiFi cards
-    if (getWirelessBandOfStandard(convertVersionToStandard(version80211primary)) == "5 GHz" ) {
-      if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "2.4 GHz" ) {
-        return "both"; // both bands are supported by the AP
-      }
-      else if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "5 GHz" ) {
-        std::cout << "ERROR: both interfaces of the AP are in the same band - "
-                  << "FINISHING SIMULATION"
-                  << std::endl;
-        NS_ASSERT(false); // both interfaces of the AP are in the same band
-        return "";
-      }
-    }
-    else if (getWirelessBandOfStandard(convertVersionToStandard(version80211primary)) == "2.4 GHz" ) {
-      if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "5 GHz" ) {
-        return "both"; // both bands are supported by the AP
-      }
-      else if (getWirelessBandOfStandard(convertVersionToStandard(version80211secondary)) == "2.4 GHz" ) {
-        std::cout << "ERROR: both interfaces of the AP are in the same band - "
-                  << "FINISHING SIMULATION"
-                  << std::endl;
-        NS_ASSERT(false); // both interfaces of the AP are in the same band
-        return "";
-      }
+    if (getWirelessBandOfVersion(version80211primary) == getWirelessBandOfVersion(version80211secondary)) {
+      std::cout << "ERROR: both interfaces of the AP are in the same band - "
+                << "FINISHING SIMULATION"
+                << std::endl;
+      NS_ASSERT(false); // both interfaces of the AP are in the same band
+      return BAND_NONE;
     }
+    return WifiBand (getWirelessBandOfVersion(version80211primary) | getWirelessBandOfVersion(version80211secondary));
   }
   else {
     // only 2 wireless cards are supported so far
     NS_ASSERT(false);
-    return "";
+    return BAND_NONE;
   }
-  return "";
 }
 
-
 // Change the frequency of a STA
 // Copied from https://groups.google.com/forum/#!topic/ns-3-users/Ih8Hgs2qgeg
 // https://10343742895474358856.googlegroups.com/attach/1b7c2a3108d5e/channel-switch-minimal.cc?part=0.1&view=1&vt=ANaJVrGFRkTkufO3dLFsc9u1J_v2-SUCAMtR0V86nVmvXWXGwwZ06cmTSv7DrQUKMWTVMt_lxuYTsrYxgVS59WU3kBd7dkkH5hQsLE8Em0FHO4jx8NbjrPk
@@ -425,7 +606,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
 
   for (uint32_t i = 0; i < deviceslink.GetN (); i++) {
 
-    if (myverbose > 1)
+    if (LOG_ENABLED (2, myverbose))
       std::cout << Simulator::Now().GetSeconds()
                 << "\t[ChangeFrequencyLocal]\tChanging channel on STA with MAC " << deviceslink.Get (i)->GetAddress () 
                 << "  to:  " << uint16_t(channel) << std::endl;
@@ -444,7 +625,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
 
       // check if the STA is already switching its channel
       if (phy0->IsStateSwitching()) {
-        if (myverbose > 1)
+        if (LOG_ENABLED (2, myverbose))
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                     << "  is already switching its channel" << std::endl; 
@@ -453,7 +634,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
         // as the STA is NOT switching its channel automatically, I do it
         phy0->SetChannelNumber (channel);
 
-        if (myverbose > 1)
+        if (LOG_ENABLED (2, myverbose))
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ChangeFrequencyLocal]\tChanged channel on STA with MAC " << deviceslink.Get (i)->GetAddress () 
                     << "  to:  " << uint16_t(channel) << std::endl;      
@@ -461,14 +642,14 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
 
       // see https://www.nsnam.org/doxygen/classns3_1_1_wifi_phy.html#ac365794e06cc92ae1262cbe72b72213d
       phy0->SetOffMode();
-      if (myverbose > 1)
+      if (LOG_ENABLED (2, myverbose))
         std::cout << Simulator::Now().GetSeconds()
                   << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                   << "  set to off mode  " << std::endl;    
 
       // see https://www.nsnam.org/doxygen/classns3_1_1_wifi_phy.html#adcc18a46c4f0faed2f05fe813cc75ed3
       phy0->ResumeFromOff();
-      if (myverbose > 1)
+      if (LOG_ENABLED (2, myverbose))
         std::cout << Simulator::Now().GetSeconds()
                   << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                   << "  set to on mode  " << std::endl;
@@ -480,7 +661,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
 
       // check if the STA is already switching its channel
       if (phy0->IsStateSwitching()) {
-        if (myverbose > 1)
+        if (LOG_ENABLED (2, myverbose))
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                     << "  is already switching its channel" << std::endl; 
@@ -489,7 +670,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
         // as the STA is NOT switching its channel automatically, I do it
         phy0->SetChannelNumber (channel);
 
-        if (myverbose > 1)
+        if (LOG_ENABLED (2, myverbose))
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ChangeFrequencyLocal]\tChanged channel on STA with MAC " << deviceslink.Get (i)->GetAddress () 
                     << "  to:  " << uint16_t(channel) << std::endl;
@@ -504,7 +685,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
       */
 
       /*
-      if (myverbose > 1)
+      if (LOG_ENABLED (2, myverbose))
         std::cout << Simulator::Now().GetSeconds()
                   << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                   << "  set to off mode  " << std::endl;   
@@ -512,7 +693,7 @@ void ChangeFrequencyLocal ( NetDeviceContainer deviceslink, uint8_t channel, uin
 
       //phy0->ResumeFromOff();
       /*
-      if (myverbose > 1)
+      if (LOG_ENABLED (2, myverbose))
         std::cout << Simulator::Now().GetSeconds()
                   << "\t[ChangeFrequencyLocal]\tSTA with MAC " << deviceslink.Get (i)->GetAddress () 
                   << "  set to on mode  " << std::endl;
@@ -883,49 +1064,86 @@ void PopulateArpCache (uint32_t nodenumber, Ptr <Node> mynode)
 /************* END of the ARP part (not used) *************/
 
 
-// Modify the max AMPDU value of a node
-void ModifyAmpdu (uint32_t nodeNumber, uint32_t ampduValue, uint32_t myverbose)
+// Handles for modifying the max AMPDU value of the WiFi devices of a node directly,
+// instead of calling Config::Set (which parses the path and matches the wildcards on each call)
+struct AmpduHandles
+{
+  bool resolved;
+  std::vector< Ptr<RegularWifiMac> > macs;  // the RegularWifiMac of each WiFi device of the node
+};
+
+std::vector<AmpduHandles> ampduHandlesVector;  // the handles of node 'i' are in position 'i'
+
+// accessors of the attributes of the 4 queues: VI, VO, BE and BK
+Ptr<const AttributeAccessor> ampduAccessors[4];
+
+// Find the RegularWifiMac of all the WiFi devices of a node. It is run for every node
+// before the simulation starts, so the search is not repeated each time the AMPDU is modified
+void ResolveAmpduHandles (uint32_t nodeNumber)
 {
   // These are the attributes of regular-wifi-mac: https://www.nsnam.org/doxygen/regular-wifi-mac_8cc_source.html
-  // You have to build a line like this (e.g. for node 0):
-  // Config::Set("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BE_MaxAmpduSize", UintegerValue(ampduValue));
-  // There are 4 queues: VI, VO, BE and BK
+  if (ampduAccessors[0] == 0) {
+    std::string attributeNames[4] = { "VI_MaxAmpduSize", "VO_MaxAmpduSize", "BE_MaxAmpduSize", "BK_MaxAmpduSize" };
+    for (uint32_t i = 0; i < 4; i++) {
+      TypeId::AttributeInformation info;
+      if (!RegularWifiMac::GetTypeId ().LookupAttributeByName (attributeNames[i], &info)) {
+        std::cout << "[ResolveAmpduHandles] ERROR: attribute " << attributeNames[i] << " not found in RegularWifiMac. Stopping the simulation\n";
+        exit (1);
+      }
+      ampduAccessors[i] = info.accessor;
+    }
+  }
 
-  // FIXME: Check if I only have to modify the parameters of all the devices (*), or only some of them.
+  if (nodeNumber >= ampduHandlesVector.size ())
+    ampduHandlesVector.resize (nodeNumber + 1);
 
-  // I use an auxiliar string for creating the first argument of Config::Set
-  std::ostringstream auxString;
+  AmpduHandles& handles = ampduHandlesVector[nodeNumber];
+  handles.macs.clear ();
 
-  // VI queue
-  auxString << "/NodeList/" << nodeNumber << "/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/VI_MaxAmpduSize";
-  // std::cout << auxString.str() << '\n';
-  Config::Set(auxString.str(),  UintegerValue(ampduValue));
+  // the same devices as "/NodeList/N/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac"
+  Ptr<Node> node = NodeList::GetNode (nodeNumber);
+  for (uint32_t i = 0; i < node->GetNDevices (); i++) {
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (node->GetDevice (i));
+    if (device == 0)
+      continue;
+    Ptr<RegularWifiMac> mac = DynamicCast<RegularWifiMac> (device->GetMac ());
+    if (mac != 0)
+      handles.macs.push_back (mac);
+  }
+  handles.resolved = true;
+}
 
-  // clean the string
-  auxString.str(std::string());
+// Release the handles. It is scheduled with Simulator::ScheduleDestroy
+void ClearAmpduHandles ()
+{
+  ampduHandlesVector.clear ();
+}
 
-  // VO queue
-  auxString << "/NodeList/" << nodeNumber << "/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/VO_MaxAmpduSize"; 
-  // std::cout << auxString.str() << '\n';
-  Config::Set(auxString.str(),  UintegerValue(ampduValue));
+// Modify the max AMPDU value of a node
+void ModifyAmpdu (uint32_t nodeNumber, uint32_t ampduValue, uint32_t myverbose)
+{
+  // This is equivalent to these lines (e.g. for node 0), for the 4 queues (VI, VO, BE and BK):
+  // Config::Set("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BE_MaxAmpduSize", UintegerValue(ampduValue));
 
-  // clean the string
-  auxString.str(std::string());
+  // FIXME: Check if I only have to modify the parameters of all the devices (*), or only some of them.
 
-  // BE queue
-  auxString << "/NodeList/" << nodeNumber << "/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BE_MaxAmpduSize"; 
-  // std::cout << auxString.str() << '\n';
-  Config::Set(auxString.str(),  UintegerValue(ampduValue));
+  // the handles are normally resolved before the simulation starts
+  if ((nodeNumber >= ampduHandlesVector.size ()) || (!ampduHandlesVector[nodeNumber].resolved))
+    ResolveAmpduHandles (nodeNumber);
 
-  // clean the string
-  auxString.str(std::string());
+  UintegerValue value (ampduValue);
+  std::vector< Ptr<RegularWifiMac> >& macs = ampduHandlesVector[nodeNumber].macs;
 
-  // BK queue
-  auxString << "/NodeList/" << nodeNumber << "/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/BK_MaxAmpduSize"; 
-  //std::cout << auxString.str() << '\n';
-  Config::Set(auxString.str(),  UintegerValue(ampduValue));  
+  for (uint32_t i = 0; i < macs.size (); i++) {
+    for (uint32_t queue = 0; queue < 4; queue++) {
+      if (!ampduAccessors[queue]->Set (PeekPointer (macs[i]), value)) {
+        std::cout << "[ModifyAmpdu] ERROR: the AMPDU of node #" << nodeNumber << " could not be modified. Stopping the simulation\n";
+        exit (1);
+      }
+    }
+  }
 
-  if ( myverbose > 1 )
+  if ( LOG_ENABLED (2, myverbose) )
     std::cout << Simulator::Now().GetSeconds()
               << "\t[ModifyAmpdu] Node #" << nodeNumber 
               << " AMPDU max size changed to " << ampduValue << " bytes" 
@@ -955,152 +1173,1269 @@ GetPosition (Ptr<Node> node)
 }
 
 
-// Print the simulation time to std::cout
-static void printTime (double period, std::string myoutputFileName, std::string myoutputFileSurname)
+// Profiler of the callbacks of this script (--profileCallbacks). Each periodic task and each trace sink
+// (SetAssoc, UnsetAssoc, CourseChange) is timed with the wall clock, and the number of calls, the total,
+// mean and 99th percentile of the wall time and the allocations are written in a table at the end of the run.
+// The time that is not spent in these callbacks is spent in ns3 itself (PHY, MAC, FlowMonitor, applications, etc.).
+// The percentile is taken from a histogram with 4 bins per power of 2, so it is an upper bound, at most 19% above
+// the real value. When the profiler is not enabled, each callback only checks a bool
+#define PROFILERBINSPEROCTAVE 4
+#define PROFILERNUMBERBINS (64 * PROFILERBINSPEROCTAVE)
+
+class CallbackProfiler
 {
-  std::cout << Simulator::Now().GetSeconds() << "\t" 
-            << myoutputFileName << "_" 
-            << myoutputFileSurname << '\n';
+  public:
+    CallbackProfiler ();
+    void Enable (bool isEnabled) { enabled = isEnabled; }
+    bool IsEnabled () const { return enabled; }
+    uint32_t GetEntry (std::string name);  // the entry of a callback. It is created the first time
+    void Add (uint32_t entry, uint64_t wallTimeNs, uint64_t allocations);
+    void Reset ();  // the counters are set to 0, but the entries are kept
+    void Write (std::ostream& os, double runWallTime) const;
+  private:
+    struct entry {
+      std::string name;
+      uint64_t calls;
+      uint64_t totalNs;
+      uint64_t allocations;
+      std::vector<uint64_t> histogram;
+    };
+    static uint32_t GetBin (uint64_t wallTimeNs);
+    static double GetBinUpperLimit (uint32_t bin);  // in ns
+    bool enabled;
+    std::vector<entry> entries;
+};
 
-  // re-schedule 
-  Simulator::Schedule (Seconds (period), &printTime, period, myoutputFileName, myoutputFileSurname);
+CallbackProfiler::CallbackProfiler ()
+{
+  enabled = false;
 }
 
+uint32_t
+CallbackProfiler::GetEntry (std::string name)
+{
+  for (uint32_t i = 0; i < entries.size (); i++)
+    if (entries[i].name == name)
+      return i;
+
+  entry newEntry;
+  newEntry.name = name;
+  newEntry.calls = 0;
+  newEntry.totalNs = 0;
+  newEntry.allocations = 0;
+  newEntry.histogram.assign (PROFILERNUMBERBINS, 0);
+  entries.push_back (newEntry);
+  return entries.size () - 1;
+}
 
-// function for tracking mobility changes
-static void 
-CourseChange (std::string foo, Ptr<const MobilityModel> mobility)
+// bin of the histogram: the power of 2 and the next 2 bits of the value
+uint32_t
+CallbackProfiler::GetBin (uint64_t wallTimeNs)
 {
-  Vector pos = mobility->GetPosition ();
-  Vector vel = mobility->GetVelocity ();
-  std::cout << Simulator::Now ().GetSeconds()
-            << "\t[CourseChange] MOBILITY CHANGE. model= " 
-            << mobility << ", POS: x=" << pos.x 
-            << ", y=" << pos.y
-            << ", z=" << pos.z 
-            << "; VEL:" << vel.x 
-            << ", y=" << vel.y
-            << ", z=" << vel.z << std::endl;
+  if (wallTimeNs < PROFILERBINSPEROCTAVE)
+    return wallTimeNs;
+  uint32_t octave = 63 - __builtin_clzll (wallTimeNs);
+  uint32_t subBin = (wallTimeNs >> (octave - 2)) & (PROFILERBINSPEROCTAVE - 1);
+  return octave * PROFILERBINSPEROCTAVE + subBin;
 }
 
+double
+CallbackProfiler::GetBinUpperLimit (uint32_t bin)
+{
+  if (bin < PROFILERBINSPEROCTAVE)
+    return bin + 1;
+  uint32_t octave = bin / PROFILERBINSPEROCTAVE;
+  uint32_t subBin = bin % PROFILERBINSPEROCTAVE;
+  return std::ldexp (1.0 + (subBin + 1) / (double) PROFILERBINSPEROCTAVE, octave);
+}
 
-// Print the statistics to an output file and/or to the screen
-void 
-print_stats ( FlowMonitor::FlowStats st, 
-              double simulationTime, 
-              uint32_t mygenerateHistograms, 
-              std::string fileName,
-              std::string fileSurname,
-              uint32_t myverbose,
-              std::string flowID,
-              uint32_t printColumnTitles ) 
+inline void
+CallbackProfiler::Add (uint32_t thisEntry, uint64_t wallTimeNs, uint64_t allocations)
 {
-  // print the results to a file (they are written at the end of the file)
-  if ( fileName != "" ) {
+  entry& e = entries[thisEntry];
+  e.calls++;
+  e.totalNs += wallTimeNs;
+  e.allocations += allocations;
+  e.histogram[GetBin (wallTimeNs)]++;
+}
 
-    std::ofstream ofs;
-    ofs.open ( fileName + "_flows.txt", std::ofstream::out | std::ofstream::app); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
+void
+CallbackProfiler::Reset ()
+{
+  for (uint32_t i = 0; i < entries.size (); i++) {
+    entries[i].calls = 0;
+    entries[i].totalNs = 0;
+    entries[i].allocations = 0;
+    entries[i].histogram.assign (PROFILERNUMBERBINS, 0);
+  }
+}
 
-    // Print a line in the output file, with the title of each column
-    if ( printColumnTitles == 1 ) {
-      ofs << "Flow_ID" << "\t"
-          << "Protocol" << "\t"
-          << "source_Address" << "\t"
-          << "source_Port" << "\t" 
-          << "destination_Address" << "\t"
-          << "destination_Port" << "\t"
-          << "Num_Tx_Packets" << "\t" 
-          << "Num_Tx_Bytes" << "\t" 
-          << "Tx_Throughput_[bps]" << "\t"  
-          << "Num_Rx_Packets" << "\t" 
-          << "Num_RX_Bytes" << "\t" 
-          << "Num_lost_packets" << "\t" 
-          << "Rx_Throughput_[bps]" << "\t"
-          << "Average_Latency_[s]" << "\t"
-          << "Average_Jitter_[s]" << "\t"
-          << "Average_Number_of_hops" << "\t"
-          << "Simulation_time_[s]" << "\n";
-    }
+// one line per callback, and a last line with the time spent in ns3
+void
+CallbackProfiler::Write (std::ostream& os, double runWallTime) const
+{
+  os << "callback" << "\t"
+     << "calls" << "\t"
+     << "total wall time [s]" << "\t"
+     << "% of the run" << "\t"
+     << "mean [us]" << "\t"
+     << "p99 [us]" << "\t"
+     << "allocations" << "\t"
+     << "allocations per call" << "\n";
+
+  double totalCallbacks = 0.0;
+  for (uint32_t i = 0; i < entries.size (); i++) {
+    const entry& e = entries[i];
+    if (e.calls == 0)
+      continue;
+
+    // the first bin that leaves 1% of the calls above it
+    uint64_t accumulated = 0;
+    uint32_t bin = 0;
+    for (bin = 0; bin < PROFILERNUMBERBINS - 1; bin++) {
+      accumulated += e.histogram[bin];
+      if (accumulated * 100 >= e.calls * 99)
+        break;
+    }
+
+    double total = e.totalNs * 1.0e-9;
+    // the sections inside a callback (e.g. 'obtainKPIs: FlowMonitor') are already included in its total
+    if (e.name.find (':') == std::string::npos)
+      totalCallbacks += total;
+
+    os << e.name << "\t"
+       << e.calls << "\t"
+       << total << "\t"
+       << (runWallTime > 0.0 ? 100.0 * total / runWallTime : 0.0) << "\t"
+       << 1.0e-3 * e.totalNs / e.calls << "\t"
+       << 1.0e-3 * GetBinUpperLimit (bin) << "\t";
+    if (PROFILE_ALLOCATIONS)
+      os << e.allocations << "\t"
+         << (double) e.allocations / e.calls << "\n";
+    else
+      os << "-" << "\t" << "-" << "\n";
+  }
+
+  os << "ns3 (rest of the events)" << "\t"
+     << Simulator::GetEventCount () << "\t"
+     << runWallTime - totalCallbacks << "\t"
+     << (runWallTime > 0.0 ? 100.0 * (runWallTime - totalCallbacks) / runWallTime : 0.0) << "\t"
+     << "-" << "\t" << "-" << "\t" << "-" << "\t" << "-" << "\n";
+}
 
-    // Print a line in the output file, with the data of this flow
-    ofs << flowID << "\t" // flowID includes the protocol, IP addresses and ports
-        << st.txPackets << "\t" 
-        << st.txBytes << "\t" 
-        << st.txBytes * 8.0 / simulationTime << "\t"  
-        << st.rxPackets << "\t" 
-        << st.rxBytes << "\t" 
-        << st.txPackets - st.rxPackets << "\t" 
-        << st.rxBytes * 8.0 / simulationTime << "\t";
+CallbackProfiler callbackProfiler;
 
-    if (st.rxPackets > 0) 
-    { 
-      ofs << (st.delaySum.GetSeconds() / st.rxPackets) <<  "\t";
+// Times the rest of the block in which it is declared, if the profiler is enabled:
+//   static uint32_t profilerEntry = callbackProfiler.GetEntry ("SetAssoc");
+//   ProfileScope profile (profilerEntry);
+class ProfileScope
+{
+  public:
+    ProfileScope (uint32_t thisEntry);
+    ~ProfileScope ();
+  private:
+    uint32_t entry;
+    std::chrono::steady_clock::time_point start;
+    uint64_t startAllocations;
+};
 
-      if (st.rxPackets > 1) { // I need at least two packets for calculating the jitter
-        ofs << (st.jitterSum.GetSeconds() / (st.rxPackets - 1.0)) << "\t";
-      } else {
-        ofs << "\t";
-      }
+inline
+ProfileScope::ProfileScope (uint32_t thisEntry)
+{
+  entry = thisEntry;
+  if (!callbackProfiler.IsEnabled ())
+    return;
+#if PROFILE_ALLOCATIONS
+  startAllocations = allocationCount;
+#else
+  startAllocations = 0;
+#endif
+  start = std::chrono::steady_clock::now ();
+}
 
-      ofs << st.timesForwarded / st.rxPackets + 1 << "\t"; 
+inline
+ProfileScope::~ProfileScope ()
+{
+  if (!callbackProfiler.IsEnabled ())
+    return;
+  uint64_t wallTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+#if PROFILE_ALLOCATIONS
+  callbackProfiler.Add (entry, wallTimeNs, allocationCount - startAllocations);
+#else
+  callbackProfiler.Add (entry, wallTimeNs, 0);
+#endif
+}
 
-    } else { //no packets arrived
-      ofs << "\t" << "\t" << "\t"; 
-    }
 
-    ofs << simulationTime << "\n";
+// A task that runs periodically (reports, KPIs, adjustment of the AMPDU)
+// Its state (file names, nodes, parameters) is stored once in the object, so each tick only schedules a pointer,
+// instead of copying all the arguments of a function. A task is created with 'new' and started with
+// periodicTasks.Start (), which deletes it when the simulator is destroyed
+class PeriodicTask
+{
+  public:
+    PeriodicTask ();
+    virtual ~PeriodicTask ();
+    void Start (double startTime, double thisPeriod);
+  protected:
+    virtual void Run () = 0;  // what is done on each tick
+    virtual std::string GetName () const = 0;  // the name in the table of the callback profiler
+  private:
+    void Tick ();
+    double period;
+    uint32_t profilerEntry;
+};
 
-    ofs.close();
+PeriodicTask::PeriodicTask ()
+{
+  period = 0.0;
+  profilerEntry = 0;
+}
 
+PeriodicTask::~PeriodicTask ()
+{
+}
 
-    // save the histogram to a file
-    if ( mygenerateHistograms > 0 ) 
-    { 
-      std::ofstream ofs_histo;
-      ofs_histo.open ( fileName + fileSurname + "_delay_histogram.txt", std::ofstream::out | std::ofstream::trunc);
+void
+PeriodicTask::Start (double startTime, double thisPeriod)
+{
+  period = thisPeriod;
+  profilerEntry = callbackProfiler.GetEntry (GetName ());
+  Simulator::Schedule (Seconds (startTime), &PeriodicTask::Tick, this);
+}
 
-      ofs_histo << "Flow #" << flowID << "\n";
-      ofs_histo << "number\tinit_interval\tend_interval\tnumber_of_samples" << std::endl; 
-      for (uint32_t i=0; i < st.delayHistogram.GetNBins (); i++) 
-        ofs_histo << i << "\t" << st.delayHistogram.GetBinStart (i) << "\t" << st.delayHistogram.GetBinEnd (i) << "\t" << st.delayHistogram.GetBinCount (i) << std::endl; 
-      ofs_histo.close();
+void
+PeriodicTask::Tick ()
+{
+  {
+    ProfileScope profile (profilerEntry);
+    Run ();
+  }
+  // re-schedule
+  Simulator::Schedule (Seconds (period), &PeriodicTask::Tick, this);
+}
 
-      ofs_histo.open ( fileName + fileSurname + "_jitter_histogram.txt", std::ofstream::out | std::ofstream::trunc); // with "trunc", Any contents that existed in the file before it is open are discarded
+// Owner of the periodic tasks
+class PeriodicTaskList
+{
+  public:
+    void Start (PeriodicTask* task, double startTime, double period);
+    void Clear ();
+  private:
+    std::vector<PeriodicTask*> tasks;
+};
 
-      ofs_histo << "Flow #" << flowID << "\n";
-      ofs_histo << "number\tinit_interval\tend_interval\tnumber_of_samples" << std::endl; 
-      for (uint32_t i=0; i < st.jitterHistogram.GetNBins (); i++ ) 
-        ofs_histo << i << "\t" << st.jitterHistogram.GetBinStart (i) << "\t" << st.jitterHistogram.GetBinEnd (i) << "\t" << st.jitterHistogram.GetBinCount (i) << std::endl; 
-      ofs_histo.close();
+void
+PeriodicTaskList::Start (PeriodicTask* task, double startTime, double period)
+{
+  tasks.push_back (task);
+  task->Start (startTime, period);
+}
 
-      ofs_histo.open ( fileName + fileSurname + "_packetsize_histogram.txt", std::ofstream::out | std::ofstream::trunc); // with "trunc", Any contents that existed in the file before it is open are discarded
+// delete all the tasks. It is scheduled with Simulator::ScheduleDestroy
+void
+PeriodicTaskList::Clear ()
+{
+  for (uint32_t i = 0; i < tasks.size (); i++)
+    delete tasks[i];
+  tasks.clear ();
+}
 
-      ofs_histo << "Flow #" << flowID << "\n";
-      ofs_histo << "number\tinit_interval\tend_interval\tnumber_of_samples"<< std::endl; 
-      for (uint32_t i=0; i < st.packetSizeHistogram.GetNBins (); i++ ) 
-        ofs_histo << i << "\t" << st.packetSizeHistogram.GetBinStart (i) << "\t" << st.packetSizeHistogram.GetBinEnd (i) << "\t" << st.packetSizeHistogram.GetBinCount (i) << std::endl; 
-      ofs_histo.close();
-    }
-  }
+PeriodicTaskList periodicTasks;
 
-  // print the results by the screen
-  if ( myverbose > 0 ) {
-    std::cout << " -Flow #" << flowID << "\n";
-    if ( mygenerateHistograms > 0) {
-      std::cout << "   The name of the output files starts with: " << fileName << fileSurname << "\n";
-      std::cout << "   Tx Packets: " << st.txPackets << "\n";
-      std::cout << "   Tx Bytes:   " << st.txBytes << "\n";
-      std::cout << "   TxOffered:  " << st.txBytes * 8.0 / simulationTime / 1000 / 1000  << " Mbps\n";
-      std::cout << "   Rx Packets: " << st.rxPackets << "\n";
-      std::cout << "   Rx Bytes:   " << st.rxBytes << "\n";
-      std::cout << "   Lost Packets: " << st.txPackets - st.rxPackets << "\n";
-      std::cout << "   Throughput: " << st.rxBytes * 8.0 / simulationTime / 1000 / 1000  << " Mbps\n";      
-    }
 
-    if (st.rxPackets > 0) // some packets have arrived
-    { 
-      std::cout << "   Mean{Delay}: " << (st.delaySum.GetSeconds() / st.rxPackets); 
-      
+// Print the simulation time to std::cout
+class PrintTimeTask : public PeriodicTask
+{
+  public:
+    PrintTimeTask (std::string myoutputFileName, std::string myoutputFileSurname);
+  protected:
+    void Run ();
+    std::string GetName () const { return "PrintTime"; }
+  private:
+    std::string name;
+};
+
+PrintTimeTask::PrintTimeTask (std::string myoutputFileName, std::string myoutputFileSurname)
+{
+  name = myoutputFileName + "_" + myoutputFileSurname;
+}
+
+void
+PrintTimeTask::Run ()
+{
+  std::cout << Simulator::Now().GetSeconds() << "\t" 
+            << name << '\n';
+}
+
+
+// Add a line with the speed of the simulator to the benchmark file (the header is written if the file is new)
+// wall times in seconds, peak RSS in kB
+static void
+saveBenchmark (std::string myBenchmarkFileName,
+                std::string myScenario,
+                double setupWallTime,
+                double runWallTime,
+                double simulatedTime)
+{
+  std::ifstream previous (myBenchmarkFileName.c_str ());
+  bool newFile = !previous.good ();
+  previous.close ();
+
+  std::ofstream ofs;
+  ofs.open (myBenchmarkFileName.c_str (), std::ofstream::out | std::ofstream::app);
+
+  if (newFile)
+    ofs << "scenario" << "\t"
+        << "setup wall time [s]" << "\t"
+        << "run wall time [s]" << "\t"
+        << "events" << "\t"
+        << "events per second" << "\t"
+        << "simulated seconds per wall second" << "\t"
+        << "peak RSS [kB]" << "\n";
+
+  uint64_t events = Simulator::GetEventCount ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage); // ru_maxrss is in kB in Linux
+
+  ofs << myScenario << "\t"
+      << setupWallTime << "\t"
+      << runWallTime << "\t"
+      << events << "\t"
+      << (runWallTime > 0.0 ? events / runWallTime : 0.0) << "\t"
+      << (runWallTime > 0.0 ? simulatedTime / runWallTime : 0.0) << "\t"
+      << usage.ru_maxrss << "\n";
+
+  ofs.close ();
+}
+
+
+// function for tracking mobility changes
+static void 
+CourseChange (std::string foo, Ptr<const MobilityModel> mobility)
+{
+  static uint32_t profilerEntry = callbackProfiler.GetEntry ("CourseChange");
+  ProfileScope profile (profilerEntry);
+
+  Vector pos = mobility->GetPosition ();
+  Vector vel = mobility->GetVelocity ();
+  std::cout << Simulator::Now ().GetSeconds()
+            << "\t[CourseChange] MOBILITY CHANGE. model= " 
+            << mobility << ", POS: x=" << pos.x 
+            << ", y=" << pos.y
+            << ", z=" << pos.z 
+            << "; VEL:" << vel.x 
+            << ", y=" << vel.y
+            << ", z=" << vel.z << std::endl;
+}
+
+
+// This class keeps the output files of the periodic functions (KPIs, AMPDU values, positions, flows)
+// open during the whole simulation. Each file has a big write buffer, so the lines are only written
+// to the disk when the buffer is full, when 'flushPeriod' seconds (of simulation time) have passed
+// since the last flush, or when the simulation is destroyed
+class KPI_sink
+{
+  public:
+    KPI_sink ();
+    void SetParameters (uint32_t thisBufferSize, double thisFlushPeriod);
+    void Create (std::string fileName);
+    std::ostream& GetStream (std::string fileName);
+    std::ostream& GetStream (std::string fileName, double now);
+    void Close ();
+    void Redirect (std::string fromPrefix, std::string toPrefix);
+    std::vector<std::string> GetFileNames ();
+  private:
+    struct sinkFile {
+      std::ofstream ofs;
+      std::vector<char> buffer;
+      double lastFlush;
+      std::string diskName;
+    };
+    sinkFile* OpenFile (std::string fileName, std::ios_base::openmode mode, double now);
+    void CheckFile (sinkFile* thisFile);
+    std::string DiskName (std::string fileName);
+    std::map<std::string, sinkFile*> files;
+    std::vector<std::string> fileNames;   // the files written so far, with the name they have on disk
+    std::vector<std::string> closedFiles; // the files that were open when Close was called, to reopen them in Redirect
+    std::string redirectFrom;
+    std::string redirectTo;
+    uint32_t bufferSize;
+    double flushPeriod;
+};
+
+KPI_sink::KPI_sink ()
+{
+  bufferSize = 1 << 20;   // 1 MB per file
+  flushPeriod = 10.0;     // seconds of simulation time
+}
+
+void
+KPI_sink::SetParameters (uint32_t thisBufferSize, double thisFlushPeriod)
+{
+  bufferSize = thisBufferSize;
+  flushPeriod = thisFlushPeriod;
+}
+
+KPI_sink::sinkFile*
+KPI_sink::OpenFile (std::string fileName, std::ios_base::openmode mode, double now)
+{
+  sinkFile* thisFile = new sinkFile;
+  thisFile->buffer.resize (bufferSize);
+  // the buffer has to be set before opening the file
+  if (bufferSize > 0)
+    thisFile->ofs.rdbuf ()->pubsetbuf (&thisFile->buffer[0], bufferSize);
+  std::string diskName = DiskName (fileName);
+  thisFile->diskName = diskName;
+  thisFile->ofs.open (diskName, mode);
+  thisFile->lastFlush = now;
+  CheckFile (thisFile);
+  if (std::find (fileNames.begin (), fileNames.end (), diskName) == fileNames.end ())
+    fileNames.push_back (diskName);
+  return thisFile;
+}
+
+// if a file cannot be opened or written, the simulation is stopped. Otherwise, the periodic output would be lost without notice
+void
+KPI_sink::CheckFile (sinkFile* thisFile)
+{
+  if (!thisFile->ofs.is_open () || thisFile->ofs.fail ()) {
+    std::cout << "[KPI_sink] ERROR: the file " << thisFile->diskName << " could not be written. Stopping the simulation\n";
+    exit (1);
+  }
+}
+
+// name of the file on disk: the same one, unless it has been redirected
+std::string
+KPI_sink::DiskName (std::string fileName)
+{
+  if ( (redirectFrom != "") && (fileName.compare (0, redirectFrom.size (), redirectFrom) == 0) )
+    return redirectTo + fileName.substr (redirectFrom.size ());
+  return fileName;
+}
+
+// create the file, discarding the previous contents (used for writing the titles of the columns)
+void
+KPI_sink::Create (std::string fileName)
+{
+  std::map<std::string, sinkFile*>::iterator it = files.find (fileName);
+  if (it != files.end ()) {
+    it->second->ofs.close ();
+    delete it->second;
+    files.erase (it);
+  }
+  files[fileName] = OpenFile (fileName, std::ofstream::out | std::ofstream::trunc, Simulator::Now ().GetSeconds ());
+}
+
+// obtain the stream where a file is written. If the file has not been created, it is opened
+// in 'app' mode, i.e. the lines are added at the end of the file
+std::ostream&
+KPI_sink::GetStream (std::string fileName)
+{
+  return GetStream (fileName, Simulator::Now ().GetSeconds ());
+}
+
+// the same, with the current simulation time. The writer thread uses it, since it cannot call the simulator
+std::ostream&
+KPI_sink::GetStream (std::string fileName, double now)
+{
+  sinkFile* thisFile;
+  std::map<std::string, sinkFile*>::iterator it = files.find (fileName);
+  if (it == files.end ()) {
+    thisFile = OpenFile (fileName, std::ofstream::out | std::ofstream::app, now);
+    files[fileName] = thisFile;
+  } else {
+    thisFile = it->second;
+  }
+
+  // time threshold: the buffer is also written if the file has not been flushed for some time
+  if ( (flushPeriod > 0.0) && (now - thisFile->lastFlush >= flushPeriod) ) {
+    thisFile->ofs.flush ();
+    CheckFile (thisFile);
+    thisFile->lastFlush = now;
+  }
+  return thisFile->ofs;
+}
+
+// write the pending lines and close all the files. It is scheduled with Simulator::ScheduleDestroy
+void
+KPI_sink::Close ()
+{
+  closedFiles.clear ();
+  for (std::map<std::string, sinkFile*>::iterator it = files.begin (); it != files.end (); it++) {
+    it->second->ofs.flush ();
+    CheckFile (it->second);
+    it->second->ofs.close ();
+    delete it->second;
+    closedFiles.push_back (it->first);
+  }
+  files.clear ();
+}
+
+// from now on, the files whose name starts with 'fromPrefix' are written with 'toPrefix' instead
+// The files must be closed. What has been written so far (e.g. the titles of the columns) is copied to the new files,
+// and the files that were open are opened again with their new name. This is done here, in the thread of the
+// simulator, so the writer thread of '--asyncOutput' does not have to open them during the run
+void
+KPI_sink::Redirect (std::string fromPrefix, std::string toPrefix)
+{
+  NS_ASSERT (files.empty ());
+  std::vector<std::string> previousNames = fileNames;
+  fileNames.clear ();
+  redirectFrom = fromPrefix;
+  redirectTo = toPrefix;
+
+  for (uint32_t i = 0; i < previousNames.size (); i++) {
+    std::string newName = DiskName (previousNames[i]);
+    std::ifstream previous (previousNames[i].c_str (), std::ios::binary);
+    std::ofstream redirected (newName.c_str (), std::ios::binary | std::ofstream::trunc);
+    redirected << previous.rdbuf ();
+    fileNames.push_back (newName);
+  }
+
+  for (uint32_t i = 0; i < closedFiles.size (); i++)
+    files[closedFiles[i]] = OpenFile (closedFiles[i], std::ofstream::out | std::ofstream::app, Simulator::Now ().GetSeconds ());
+  closedFiles.clear ();
+}
+
+// the files written so far
+std::vector<std::string>
+KPI_sink::GetFileNames ()
+{
+  return fileNames;
+}
+
+KPI_sink kpiSink;  // shared by all the functions that periodically write to a file
+
+
+// Writers of the periodic files (KPIs, AMPDU values, positions). Each file has a fixed schema (its columns), and
+// the rows are written as tab-separated text ('.txt') or, with '--binaryOutput=1', in a compact columnar binary
+// format ('.col'). Both are written through kpiSink, so buffering, fork mode and closing work in the same way.
+// Layout of the columnar files (native byte order, little endian in x86; every part is padded to 8 bytes, so the
+// file can be mapped in memory and each column of a block used as an array):
+//   "WSSCOL02", uint32 number of columns, uint32 size of the description of the columns (including padding),
+//   uint32 flags (bit 0: the text version of the file has a tab at the end of each line), uint32 0
+//   each column: uint8 type, uint8 nullable, uint16 number of labels,
+//                and then the name, the text of the null value and the labels, each one as uint16 length + characters
+//   blocks: uint32 number of rows, uint32 0, and the values of each column, one column after the other
+// Types: 'd' double, 'u' uint32, 'e' uint8 (index of a label). Null values: NaN ('d') and 0xFFFFFFFF ('u')
+// 'columnar-reader.h' reads these files, and 'columnar-to-tsv.cc' converts them to tab-separated text
+#define COLUMNARBLOCKROWS 8192  // rows kept in memory before a block is written
+
+// With '--asyncOutput=1', the simulation does not format or write anything during the run: the periodic functions
+// only put the values of each row in a fixed-size record, which goes through a lock-free queue (a single producer,
+// the simulation, and a single consumer) to a writer thread. The writer thread formats the rows and writes them.
+// The ascii mobility trace, which ns3 formats itself, is written by the writer thread in big pieces
+#define OUTPUTRECORDVALUES 14     // maximum number of columns of a periodic file
+#define OUTPUTQUEUESIZE 16384     // records in the queue. It must be a power of 2
+#define ASYNCSTREAMCHUNK 65536    // size of the pieces of the mobility trace
+#define OUTPUTWAKEUPRECORDS 256   // the writer thread sleeps until the queue has this number of records
+
+class RowWriter;
+class AsyncStreambuf;
+
+// A row of a periodic file, or a piece of a stream
+struct outputRecord {
+  RowWriter* writer;          // NULL if it is a piece of a stream
+  AsyncStreambuf* stream;
+  char* data;                 // the piece of the stream
+  uint32_t size;
+  uint32_t numberValues;
+  uint32_t nullMask;          // bit i is set if the value of column i is null
+  double now;                 // simulation time when the row was added
+  union {
+    double d;
+    uint32_t u;
+  } values[OUTPUTRECORDVALUES];
+};
+
+// Lock-free queue with a single producer and a single consumer
+class OutputQueue
+{
+  public:
+    OutputQueue ();
+    bool Push (const outputRecord& record);  // false if the queue is full
+    bool Pop (outputRecord* record);         // false if the queue is empty
+    uint64_t Size () const;
+  private:
+    std::vector<outputRecord> records;
+    alignas (64) std::atomic<uint64_t> head;  // next record to be read. Only modified by the consumer
+    alignas (64) std::atomic<uint64_t> tail;  // next record to be written. Only modified by the producer
+};
+
+OutputQueue::OutputQueue ()
+  : records (OUTPUTQUEUESIZE),
+    head (0),
+    tail (0)
+{
+}
+
+inline bool
+OutputQueue::Push (const outputRecord& record)
+{
+  uint64_t thisTail = tail.load (std::memory_order_relaxed);
+  if (thisTail - head.load (std::memory_order_acquire) == OUTPUTQUEUESIZE)
+    return false;
+  records[thisTail & (OUTPUTQUEUESIZE - 1)] = record;
+  tail.store (thisTail + 1, std::memory_order_release);
+  return true;
+}
+
+inline bool
+OutputQueue::Pop (outputRecord* record)
+{
+  uint64_t thisHead = head.load (std::memory_order_relaxed);
+  if (thisHead == tail.load (std::memory_order_acquire))
+    return false;
+  *record = records[thisHead & (OUTPUTQUEUESIZE - 1)];
+  head.store (thisHead + 1, std::memory_order_release);
+  return true;
+}
+
+inline uint64_t
+OutputQueue::Size () const
+{
+  return tail.load (std::memory_order_acquire) - head.load (std::memory_order_acquire);
+}
+
+// The writer thread. It only runs during Simulator::Run (). Before and after it, everything is written directly.
+// While it runs, only the writer thread uses the periodic files (kpiSink and rowSink)
+// When the queue is empty, the writer thread sleeps on a condition variable, and the simulation wakes it when there are
+// OUTPUTWAKEUPRECORDS records (or at the end). If the queue is full, the simulation sleeps until the writer frees
+// some space. The mutex is only taken by a thread that is going to sleep, or to wake the other one
+class AsyncOutput
+{
+  public:
+    AsyncOutput ();
+    void Enable (bool isEnabled) { enabled = isEnabled; }
+    bool IsEnabled () const { return enabled; }
+    bool IsRunning () const { return running; }
+    void Start ();
+    void Stop ();
+    void Push (const outputRecord& record);
+    Ptr<OutputStreamWrapper> CreateStream (std::string fileName);
+    void Close ();
+  private:
+    void WriterLoop ();
+    void Write (const outputRecord& record);
+    bool enabled;
+    bool running;
+    std::atomic<bool> stopping;
+    OutputQueue queue;
+    std::mutex mutex;
+    std::condition_variable recordsAvailable;   // the writer thread waits on it
+    std::condition_variable spaceAvailable;     // the simulation waits on it
+    std::atomic<bool> writerWaiting;
+    std::atomic<bool> simulationWaiting;
+    std::thread writer;
+    std::vector<AsyncStreambuf*> streams;
+    std::vector<std::ostream*> ostreams;
+};
+
+AsyncOutput asyncOutput;
+
+
+class RowWriter
+{
+  public:
+    RowWriter (std::string thisFileName, bool thisColumnar);
+    void AddColumn (std::string name, char type, bool nullable = false, std::string nullText = "");
+    void AddEnumColumn (std::string name, std::vector<std::string> labels);
+    void SetTrailingTab () { trailingTab = true; }
+    void WriteHeader ();
+    RowWriter& Double (double value);
+    RowWriter& Uint (uint32_t value);
+    RowWriter& Enum (uint8_t value);
+    RowWriter& Null ();
+    void EndRow ();
+    void WriteRow (const outputRecord& row);
+    void Flush ();
+  private:
+    struct column {
+      char type;
+      bool nullable;
+      std::string name;
+      std::string nullText;
+      std::vector<std::string> labels;
+      std::vector<char> values;
+    };
+    void Append (uint32_t i, const void* value, uint32_t size);
+    void WriteBlock (std::ostream& ofs);
+    std::string fileName;
+    bool columnar;
+    bool trailingTab;       // text: a tab is added at the end of each line
+    uint32_t rows;          // rows of the current block
+    outputRecord row;       // the row that is being filled
+    std::vector<column> columns;
+};
+
+RowWriter::RowWriter (std::string thisFileName, bool thisColumnar)
+{
+  fileName = thisFileName;
+  columnar = thisColumnar;
+  trailingTab = false;
+  rows = 0;
+  row.writer = this;
+  row.stream = NULL;
+  row.data = NULL;
+  row.size = 0;
+  row.numberValues = 0;
+  row.nullMask = 0;
+}
+
+// add a column of type 'd' or 'u'. If it is nullable, the null values are converted to 'nullText' (e.g. "-")
+void
+RowWriter::AddColumn (std::string name, char type, bool nullable, std::string nullText)
+{
+  NS_ASSERT ( (type == 'd') || (type == 'u') );
+  NS_ASSERT (columns.size () < OUTPUTRECORDVALUES);
+  column thisColumn;
+  thisColumn.type = type;
+  thisColumn.nullable = nullable;
+  thisColumn.name = name;
+  thisColumn.nullText = nullText;
+  if (columnar)
+    thisColumn.values.reserve (COLUMNARBLOCKROWS * (type == 'd' ? sizeof (double) : sizeof (uint32_t)));
+  columns.push_back (thisColumn);
+}
+
+// add a column whose values are one of these labels (e.g. the application of a flow)
+void
+RowWriter::AddEnumColumn (std::string name, std::vector<std::string> labels)
+{
+  NS_ASSERT (labels.size () < 256);
+  NS_ASSERT (columns.size () < OUTPUTRECORDVALUES);
+  column thisColumn;
+  thisColumn.type = 'e';
+  thisColumn.nullable = false;
+  thisColumn.name = name;
+  thisColumn.labels = labels;
+  if (columnar)
+    thisColumn.values.reserve (COLUMNARBLOCKROWS);
+  columns.push_back (thisColumn);
+}
+
+// write the titles of the columns (text) or their description (columnar). The file must have been created with kpiSink.Create
+void
+RowWriter::WriteHeader ()
+{
+  std::ostream& ofs = kpiSink.GetStream (fileName);
+
+  if (!columnar) {
+    for (uint32_t i = 0; i < columns.size (); i++)
+      ofs << columns[i].name << ( (i + 1 < columns.size ()) || trailingTab ? "\t" : "");
+    ofs << "\n";
+    return;
+  }
+
+  std::string description;
+  for (uint32_t i = 0; i < columns.size (); i++) {
+    uint8_t type = columns[i].type;
+    uint8_t nullable = columns[i].nullable;
+    uint16_t numberLabels = columns[i].labels.size ();
+    description.append ((const char*) &type, sizeof (type));
+    description.append ((const char*) &nullable, sizeof (nullable));
+    description.append ((const char*) &numberLabels, sizeof (numberLabels));
+
+    std::vector<std::string> texts;
+    texts.push_back (columns[i].name);
+    texts.push_back (columns[i].nullText);
+    texts.insert (texts.end (), columns[i].labels.begin (), columns[i].labels.end ());
+    for (uint32_t j = 0; j < texts.size (); j++) {
+      uint16_t length = texts[j].size ();
+      description.append ((const char*) &length, sizeof (length));
+      description.append (texts[j]);
+    }
+  }
+  description.resize ((description.size () + 7) / 8 * 8, '\0');
+
+  uint32_t numberColumns = columns.size ();
+  uint32_t descriptionSize = description.size ();
+  uint32_t flags = trailingTab ? 1 : 0;
+  uint32_t padding = 0;
+  ofs.write ("WSSCOL02", 8);
+  ofs.write ((const char*) &numberColumns, sizeof (numberColumns));
+  ofs.write ((const char*) &descriptionSize, sizeof (descriptionSize));
+  ofs.write ((const char*) &flags, sizeof (flags));
+  ofs.write ((const char*) &padding, sizeof (padding));
+  ofs.write (description.data (), description.size ());
+}
+
+RowWriter&
+RowWriter::Double (double value)
+{
+  NS_ASSERT (columns[row.numberValues].type == 'd');
+  row.values[row.numberValues++].d = value;
+  return *this;
+}
+
+RowWriter&
+RowWriter::Uint (uint32_t value)
+{
+  NS_ASSERT (columns[row.numberValues].type == 'u');
+  row.values[row.numberValues++].u = value;
+  return *this;
+}
+
+RowWriter&
+RowWriter::Enum (uint8_t value)
+{
+  NS_ASSERT ( (columns[row.numberValues].type == 'e') && (value < columns[row.numberValues].labels.size ()) );
+  row.values[row.numberValues++].u = value;
+  return *this;
+}
+
+RowWriter&
+RowWriter::Null ()
+{
+  NS_ASSERT (columns[row.numberValues].nullable);
+  row.nullMask |= 1 << row.numberValues;
+  row.numberValues++;
+  return *this;
+}
+
+// all the columns of the row have a value. It is written now, or sent to the writer thread
+void
+RowWriter::EndRow ()
+{
+  NS_ASSERT (row.numberValues == columns.size ());
+  row.now = Simulator::Now ().GetSeconds ();
+  if (asyncOutput.IsRunning ())
+    asyncOutput.Push (row);
+  else
+    WriteRow (row);
+  row.numberValues = 0;
+  row.nullMask = 0;
+}
+
+void
+RowWriter::Append (uint32_t i, const void* value, uint32_t size)
+{
+  const char* bytes = (const char*) value;
+  columns[i].values.insert (columns[i].values.end (), bytes, bytes + size);
+}
+
+// format a row (text) or add it to the current block (columnar), which is written when it is full
+// It does not use the simulator, since it may be called by the writer thread
+void
+RowWriter::WriteRow (const outputRecord& thisRow)
+{
+  if (!columnar) {
+    std::ostream& ofs = kpiSink.GetStream (fileName, thisRow.now);
+    for (uint32_t i = 0; i < columns.size (); i++) {
+      if (thisRow.nullMask & (1 << i))
+        ofs << columns[i].nullText;
+      else if (columns[i].type == 'd')
+        ofs << thisRow.values[i].d;
+      else if (columns[i].type == 'u')
+        ofs << thisRow.values[i].u;
+      else
+        ofs << columns[i].labels[thisRow.values[i].u];
+      if ( (i + 1 < columns.size ()) || trailingTab )
+        ofs << "\t";
+    }
+    ofs << "\n";
+    return;
+  }
+
+  for (uint32_t i = 0; i < columns.size (); i++) {
+    bool null = (thisRow.nullMask & (1 << i)) != 0;
+    if (columns[i].type == 'd') {
+      double value = null ? std::numeric_limits<double>::quiet_NaN () : thisRow.values[i].d;
+      Append (i, &value, sizeof (value));
+    }
+    else if (columns[i].type == 'u') {
+      uint32_t value = null ? 0xFFFFFFFF : thisRow.values[i].u;
+      Append (i, &value, sizeof (value));
+    }
+    else {
+      uint8_t value = thisRow.values[i].u;
+      Append (i, &value, sizeof (value));
+    }
+  }
+  rows++;
+  if (rows == COLUMNARBLOCKROWS)
+    WriteBlock (kpiSink.GetStream (fileName, thisRow.now));
+}
+
+// write the rows of the current block (nothing if there are no rows)
+void
+RowWriter::WriteBlock (std::ostream& ofs)
+{
+  if (rows == 0)
+    return;
+
+  uint32_t blockHeader[2] = { rows, 0 };
+  ofs.write ((const char*) blockHeader, sizeof (blockHeader));
+
+  const char padding[8] = { 0 };
+  for (uint32_t i = 0; i < columns.size (); i++) {
+    ofs.write (&columns[i].values[0], columns[i].values.size ());
+    ofs.write (padding, (8 - columns[i].values.size () % 8) % 8);
+    columns[i].values.clear ();
+  }
+  rows = 0;
+}
+
+// write the rows of the current block. The text files have nothing pending
+void
+RowWriter::Flush ()
+{
+  if (columnar && (rows > 0))
+    WriteBlock (kpiSink.GetStream (fileName));
+}
+
+
+// The ascii mobility trace of ns3 writes each line with std::endl, i.e. it is written to the disk line by line.
+// With this buffer, the lines are kept in pieces of ASYNCSTREAMCHUNK bytes, which are written by the writer thread
+class AsyncStreambuf : public std::streambuf
+{
+  public:
+    AsyncStreambuf (std::string fileName);
+    ~AsyncStreambuf ();
+    void HandOver ();
+    void WriteChunk (char* data, uint32_t size);
+  protected:
+    int overflow (int c);
+    int sync ();
+  private:
+    std::ofstream file;
+    char* buffer;
+};
+
+AsyncStreambuf::AsyncStreambuf (std::string fileName)
+{
+  file.open (fileName.c_str (), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+  NS_ASSERT (file.is_open ());
+  buffer = new char[ASYNCSTREAMCHUNK];
+  setp (buffer, buffer + ASYNCSTREAMCHUNK);
+}
+
+AsyncStreambuf::~AsyncStreambuf ()
+{
+  HandOver ();
+  file.close ();
+  delete[] buffer;
+}
+
+// the characters written so far go to the file: through the writer thread if it is running, or directly
+void
+AsyncStreambuf::HandOver ()
+{
+  uint32_t size = pptr () - pbase ();
+  if (size == 0)
+    return;
+
+  if (asyncOutput.IsRunning ()) {
+    outputRecord piece;
+    piece.writer = NULL;
+    piece.stream = this;
+    piece.data = buffer;
+    piece.size = size;
+    asyncOutput.Push (piece);
+    buffer = new char[ASYNCSTREAMCHUNK];  // the writer thread deletes the previous one
+  }
+  else {
+    file.write (buffer, size);
+  }
+  setp (buffer, buffer + ASYNCSTREAMCHUNK);
+}
+
+// called by the writer thread
+void
+AsyncStreambuf::WriteChunk (char* data, uint32_t size)
+{
+  file.write (data, size);
+  delete[] data;
+}
+
+int
+AsyncStreambuf::overflow (int c)
+{
+  HandOver ();
+  if (c != traits_type::eof ()) {
+    *pptr () = c;
+    pbump (1);
+  }
+  return traits_type::not_eof (c);
+}
+
+// std::endl does not write anything: the lines stay in the buffer until it is full
+int
+AsyncStreambuf::sync ()
+{
+  return 0;
+}
+
+
+AsyncOutput::AsyncOutput ()
+  : stopping (false),
+    writerWaiting (false),
+    simulationWaiting (false)
+{
+  enabled = false;
+  running = false;
+}
+
+// start the writer thread. It is called just before Simulator::Run (), so in fork mode each child has its own thread
+void
+AsyncOutput::Start ()
+{
+  if (!enabled || running)
+    return;
+  stopping.store (false);
+  running = true;
+  writer = std::thread (&AsyncOutput::WriterLoop, this);
+}
+
+// everything in the queue is written, and the writer thread finishes. It is called when Simulator::Run () returns
+void
+AsyncOutput::Stop ()
+{
+  if (!running)
+    return;
+  for (uint32_t i = 0; i < streams.size (); i++)
+    streams[i]->HandOver ();
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    stopping.store (true);
+  }
+  recordsAvailable.notify_one ();
+  writer.join ();
+  running = false;
+}
+
+// if the queue is full, the simulation waits for the writer thread
+// The flag of the thread that sleeps and the queue are checked with sequentially consistent fences in both threads,
+// so either the thread that sleeps sees the new state of the queue, or the other thread sees the flag and wakes it
+void
+AsyncOutput::Push (const outputRecord& record)
+{
+  while (!queue.Push (record)) {
+    std::unique_lock<std::mutex> lock (mutex);
+    simulationWaiting.store (true, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    spaceAvailable.wait (lock, [this] () { return queue.Size () < OUTPUTQUEUESIZE; });
+    simulationWaiting.store (false, std::memory_order_relaxed);
+  }
+
+  std::atomic_thread_fence (std::memory_order_seq_cst);
+  if (writerWaiting.load (std::memory_order_relaxed) && (queue.Size () >= OUTPUTWAKEUPRECORDS)) {
+    std::lock_guard<std::mutex> lock (mutex);
+    recordsAvailable.notify_one ();
+  }
+}
+
+void
+AsyncOutput::Write (const outputRecord& record)
+{
+  if (record.writer != NULL)
+    record.writer->WriteRow (record);
+  else
+    record.stream->WriteChunk (record.data, record.size);
+}
+
+void
+AsyncOutput::WriterLoop ()
+{
+  outputRecord record;
+  while (true) {
+    if (queue.Pop (&record)) {
+      Write (record);
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      if (simulationWaiting.load (std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock (mutex);
+        spaceAvailable.notify_one ();
+      }
+    }
+    else if (stopping.load (std::memory_order_acquire)) {
+      // nothing else is added after 'stopping'
+      while (queue.Pop (&record))
+        Write (record);
+      return;
+    }
+    else {
+      std::unique_lock<std::mutex> lock (mutex);
+      writerWaiting.store (true, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      recordsAvailable.wait (lock, [this] () { return (queue.Size () >= OUTPUTWAKEUPRECORDS) || stopping.load (); });
+      writerWaiting.store (false, std::memory_order_relaxed);
+    }
+  }
+}
+
+// a file written with AsyncStreambuf, e.g. for MobilityHelper::EnableAsciiAll. It is deleted when the simulator is
+// destroyed, after the nodes, so no trace uses it after that
+Ptr<OutputStreamWrapper>
+AsyncOutput::CreateStream (std::string fileName)
+{
+  AsyncStreambuf* stream = new AsyncStreambuf (fileName);
+  std::ostream* os = new std::ostream (stream);
+  streams.push_back (stream);
+  ostreams.push_back (os);
+  if (streams.size () == 1)
+    Simulator::ScheduleDestroy (&AsyncOutput::Close, this);
+  return Create<OutputStreamWrapper> (os);
+}
+
+// write what is pending in the streams and close them. It is scheduled with Simulator::ScheduleDestroy
+void
+AsyncOutput::Close ()
+{
+  NS_ASSERT (!running);
+  for (uint32_t i = 0; i < streams.size (); i++) {
+    delete ostreams[i];
+    delete streams[i];
+  }
+  streams.clear ();
+  ostreams.clear ();
+}
+
+// ascii trace of the mobility of all the nodes. With '--asyncOutput=1', it is written by the writer thread
+static void
+EnableMobilityTrace (std::string fileName)
+{
+  if (asyncOutput.IsEnabled ()) {
+    MobilityHelper::EnableAsciiAll (asyncOutput.CreateStream (fileName));
+  }
+  else {
+    AsciiTraceHelper ascii;
+    MobilityHelper::EnableAsciiAll (ascii.CreateFileStream (fileName));
+  }
+}
+
+
+// The writers of the periodic files, by name
+class Row_sink
+{
+  public:
+    RowWriter* Create (std::string fileName, bool columnar);
+    RowWriter* Find (std::string fileName);
+    void Close ();
+  private:
+    std::map<std::string, RowWriter*> writers;
+};
+
+// create the file in kpiSink. The columns have to be added, and then WriteHeader called
+RowWriter*
+Row_sink::Create (std::string fileName, bool columnar)
+{
+  NS_ASSERT (writers.find (fileName) == writers.end ());
+  kpiSink.Create (fileName); // Any contents that existed in the file before are discarded
+  RowWriter* writer = new RowWriter (fileName, columnar);
+  writers[fileName] = writer;
+  return writer;
+}
+
+// the writer of the file, or NULL if it has not been created
+RowWriter*
+Row_sink::Find (std::string fileName)
+{
+  std::map<std::string, RowWriter*>::iterator it = writers.find (fileName);
+  if (it == writers.end ())
+    return NULL;
+  return it->second;
+}
+
+// write the last blocks. It is scheduled with Simulator::ScheduleDestroy, before kpiSink closes the files
+void
+Row_sink::Close ()
+{
+  for (std::map<std::string, RowWriter*>::iterator it = writers.begin (); it != writers.end (); it++) {
+    it->second->Flush ();
+    delete it->second;
+  }
+  writers.clear ();
+}
+
+Row_sink rowSink;
+
+
+// Print the statistics to an output file and/or to the screen
+void 
+print_stats ( FlowMonitor::FlowStats st, 
+              double simulationTime, 
+              uint32_t mygenerateHistograms, 
+              std::string fileName,
+              uint32_t myverbose,
+              std::string flowID,
+              uint32_t printColumnTitles ) 
+{
+  // print the results to a file (they are written at the end of the file)
+  if ( fileName != "" ) {
+
+    std::ostream& ofs = kpiSink.GetStream (fileName + "_flows.txt"); // the file is kept open until the end
+
+    // Print a line in the output file, with the title of each column
+    if ( printColumnTitles == 1 ) {
+      ofs << "Flow_ID" << "\t"
+          << "Protocol" << "\t"
+          << "source_Address" << "\t"
+          << "source_Port" << "\t" 
+          << "destination_Address" << "\t"
+          << "destination_Port" << "\t"
+          << "Num_Tx_Packets" << "\t" 
+          << "Num_Tx_Bytes" << "\t" 
+          << "Tx_Throughput_[bps]" << "\t"  
+          << "Num_Rx_Packets" << "\t" 
+          << "Num_RX_Bytes" << "\t" 
+          << "Num_lost_packets" << "\t" 
+          << "Rx_Throughput_[bps]" << "\t"
+          << "Average_Latency_[s]" << "\t"
+          << "Average_Jitter_[s]" << "\t"
+          << "Average_Number_of_hops" << "\t"
+          << "Simulation_time_[s]" << "\n";
+    }
+
+    // Print a line in the output file, with the data of this flow
+    ofs << flowID << "\t" // flowID includes the protocol, IP addresses and ports
+        << st.txPackets << "\t" 
+        << st.txBytes << "\t" 
+        << st.txBytes * 8.0 / simulationTime << "\t"  
+        << st.rxPackets << "\t" 
+        << st.rxBytes << "\t" 
+        << st.txPackets - st.rxPackets << "\t" 
+        << st.rxBytes * 8.0 / simulationTime << "\t";
+
+    if (st.rxPackets > 0) 
+    { 
+      ofs << (st.delaySum.GetSeconds() / st.rxPackets) <<  "\t";
+
+      if (st.rxPackets > 1) { // I need at least two packets for calculating the jitter
+        ofs << (st.jitterSum.GetSeconds() / (st.rxPackets - 1.0)) << "\t";
+      } else {
+        ofs << "\t";
+      }
+
+      ofs << st.timesForwarded / st.rxPackets + 1 << "\t"; 
+
+    } else { //no packets arrived
+      ofs << "\t" << "\t" << "\t"; 
+    }
+
+    ofs << simulationTime << "\n";
+
+  }
+
+  // print the results by the screen
+  if ( LOG_ENABLED (1, myverbose) ) {
+    std::cout << " -Flow #" << flowID << "\n";
+    if ( mygenerateHistograms > 0) {
+      std::cout << "   The histograms of the flow are in: " << fileName << "_histograms.txt\n";
+      std::cout << "   Tx Packets: " << st.txPackets << "\n";
+      std::cout << "   Tx Bytes:   " << st.txBytes << "\n";
+      std::cout << "   TxOffered:  " << st.txBytes * 8.0 / simulationTime / 1000 / 1000  << " Mbps\n";
+      std::cout << "   Rx Packets: " << st.rxPackets << "\n";
+      std::cout << "   Rx Bytes:   " << st.rxBytes << "\n";
+      std::cout << "   Lost Packets: " << st.txPackets - st.rxPackets << "\n";
+      std::cout << "   Throughput: " << st.rxBytes * 8.0 / simulationTime / 1000 / 1000  << " Mbps\n";      
+    }
+
+    if (st.rxPackets > 0) // some packets have arrived
+    { 
+      std::cout << "   Mean{Delay}: " << (st.delaySum.GetSeconds() / st.rxPackets); 
+      
       if (st.rxPackets > 1) // I need at least two packets for calculating the jitter
       { 
         std::cout << "   Mean{Jitter}: " << (st.jitterSum.GetSeconds() / (st.rxPackets - 1.0 ));
@@ -1116,7 +2451,7 @@ print_stats ( FlowMonitor::FlowStats st,
       std::cout << "   Mean{Hop Count}: no packets arrived. \n"; 
     }
 
-    if (( mygenerateHistograms > 0 ) && ( myverbose > 3 )) 
+    if (( mygenerateHistograms > 0 ) && ( LOG_ENABLED (4, myverbose) )) 
     { 
       std::cout << "   Delay Histogram" << std::endl; 
       for (uint32_t i=0; i < st.delayHistogram.GetNBins (); i++) 
@@ -1150,6 +2485,209 @@ print_stats ( FlowMonitor::FlowStats st,
 } 
 
 
+// The delay, jitter and packet size histograms of all the flows of a run (generateHistograms > 0), in a single file:
+// first a directory, with a line per histogram (flow, application, histogram, number of bins, offset and size in bytes),
+// and then the histograms. The offsets are counted from the beginning of the line after '#data', so a histogram can be
+// read directly. Each one has the same lines as the separate file of the previous versions (_flow_1_delay_histogram.txt, etc.)
+// The histograms of the flows of each application are also added in memory, and stored with flow 'all'
+class HistogramStore
+{
+  public:
+    void Add (FlowId flowId, std::string application, std::string flowID, const FlowMonitor::FlowStats& st);
+    void Write (std::string fileName);
+  private:
+    struct entry {
+      std::string flow;
+      std::string application;
+      std::string histogram;
+      uint32_t bins;
+      std::string text;
+    };
+    struct merged {
+      std::string application;
+      std::vector<double> binWidth;               // one per histogram: delay, jitter, packet size
+      std::vector<std::vector<uint64_t> > counts;
+    };
+    void AddEntry (std::string flow, std::string application, std::string histogram, uint32_t bins, std::string text);
+    std::vector<entry> entries;
+    std::vector<merged> applications;               // in order of appearance
+};
+
+const char* HistogramNames[3] = { "delay", "jitter", "packetsize" };
+
+void
+HistogramStore::AddEntry (std::string flow, std::string application, std::string histogram, uint32_t bins, std::string text)
+{
+  entry thisEntry;
+  thisEntry.flow = flow;
+  thisEntry.application = application;
+  thisEntry.histogram = histogram;
+  thisEntry.bins = bins;
+  thisEntry.text = text;
+  entries.push_back (thisEntry);
+}
+
+// 'flowID' is the text that describes the flow in the '_flows.txt' file
+void
+HistogramStore::Add (FlowId flowId, std::string application, std::string flowID, const FlowMonitor::FlowStats& st)
+{
+  std::ostringstream flow;
+  flow << flowId;
+  if (application == "")
+    application = "other";
+
+  const Histogram* histograms[3] = { &st.delayHistogram, &st.jitterHistogram, &st.packetSizeHistogram };
+
+  uint32_t a = 0;
+  while ( (a < applications.size ()) && (applications[a].application != application) )
+    a++;
+  if (a == applications.size ()) {
+    merged newApplication;
+    newApplication.application = application;
+    newApplication.binWidth.assign (3, 0.0);
+    newApplication.counts.resize (3);
+    applications.push_back (newApplication);
+  }
+
+  for (uint32_t j = 0; j < 3; j++) {
+    // the lines of the histogram, as they were written in a separate file
+    std::ostringstream text;
+    text << "Flow #" << flowID << "\n";
+    text << "number\tinit_interval\tend_interval\tnumber_of_samples" << "\n";
+    for (uint32_t i = 0; i < histograms[j]->GetNBins (); i++)
+      text << i << "\t" << histograms[j]->GetBinStart (i) << "\t" << histograms[j]->GetBinEnd (i) << "\t" << histograms[j]->GetBinCount (i) << "\n";
+    AddEntry (flow.str (), application, HistogramNames[j], histograms[j]->GetNBins (), text.str ());
+
+    // all the flows use the same bin width (an attribute of FlowMonitor), so the bins can be added by index
+    merged& thisApplication = applications[a];
+    if (histograms[j]->GetNBins () > 0)
+      thisApplication.binWidth[j] = histograms[j]->GetBinWidth (0);
+    if (thisApplication.counts[j].size () < histograms[j]->GetNBins ())
+      thisApplication.counts[j].resize (histograms[j]->GetNBins (), 0);
+    for (uint32_t i = 0; i < histograms[j]->GetNBins (); i++)
+      thisApplication.counts[j][i] += histograms[j]->GetBinCount (i);
+  }
+}
+
+// write the directory and all the histograms, including the ones of each application
+void
+HistogramStore::Write (std::string fileName)
+{
+  for (uint32_t a = 0; a < applications.size (); a++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      const std::vector<uint64_t>& counts = applications[a].counts[j];
+      double binWidth = applications[a].binWidth[j];
+      std::ostringstream text;
+      text << "Application " << applications[a].application << "\n";
+      text << "number\tinit_interval\tend_interval\tnumber_of_samples" << "\n";
+      for (uint32_t i = 0; i < counts.size (); i++)
+        text << i << "\t" << i * binWidth << "\t" << (i + 1) * binWidth << "\t" << counts[i] << "\n";
+      AddEntry ("all", applications[a].application, HistogramNames[j], counts.size (), text.str ());
+    }
+  }
+
+  std::ofstream ofs (fileName.c_str (), std::ofstream::out | std::ofstream::trunc);
+  ofs << "flow\tapplication\thistogram\tbins\toffset\tbytes\n";
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < entries.size (); i++) {
+    ofs << entries[i].flow << "\t"
+        << entries[i].application << "\t"
+        << entries[i].histogram << "\t"
+        << entries[i].bins << "\t"
+        << offset << "\t"
+        << entries[i].text.size () << "\n";
+    offset += entries[i].text.size ();
+  }
+  ofs << "#data\n";
+  for (uint32_t i = 0; i < entries.size (); i++)
+    ofs << entries[i].text;
+  ofs.close ();
+
+  entries.clear ();
+  applications.clear ();
+}
+
+
+// The average values of a run (latency, loss, throughput, etc.). They are either added as a line at the end of
+// '_average.txt' (label and value of each one), or written to a file of their own (a shard) in a results folder:
+//   <resultsFolder>/<outputFileSurname>.res
+// A shard has two lines: the names of the columns and the values. The first columns are 'point', 'surname' and
+// 'RngRun', and then the metrics, with an empty value if the metric has not been obtained (e.g. no VoIP packets).
+// So each run writes its own file, and the runs of a sweep can write at the same time without locks.
+// 'merge-results.cc' aggregates them (mean, standard deviation and confidence interval of each point)
+class ResultRecord
+{
+  public:
+    void Add (std::string name, double value, bool valid = true);
+    void AppendLine (std::string fileName, std::string surname);
+    void WriteShard (std::string folder, std::string surname, std::string point, uint64_t run);
+  private:
+    struct metric {
+      std::string name;
+      double value;
+      bool valid;
+    };
+    std::vector<metric> metrics;
+};
+
+void
+ResultRecord::Add (std::string name, double value, bool valid)
+{
+  metric thisMetric;
+  thisMetric.name = name;
+  thisMetric.value = value;
+  thisMetric.valid = valid;
+  metrics.push_back (thisMetric);
+}
+
+// the line of '_average.txt': the surname, and then the name and the value of each metric
+void
+ResultRecord::AppendLine (std::string fileName, std::string surname)
+{
+  std::ofstream ofs;
+  ofs.open (fileName, std::ofstream::out | std::ofstream::app); // with "app", all output operations happen at the end of the file, appending to its existing contents
+  ofs << surname;
+  for (uint32_t i = 0; i < metrics.size (); i++) {
+    ofs << "\t" << metrics[i].name << "\t";
+    if (metrics[i].valid)
+      ofs << metrics[i].value;
+  }
+  ofs << "\n";
+  ofs.close ();
+}
+
+// the shard is written with a temporary name and then renamed, so a reader never finds it half written
+void
+ResultRecord::WriteShard (std::string folder, std::string surname, std::string point, uint64_t run)
+{
+  mkdir (folder.c_str (), 0777);  // it may already exist
+
+  std::string fileName = folder + "/" + surname + ".res";
+  std::ostringstream temporaryName;
+  temporaryName << fileName << ".tmp" << getpid ();
+
+  std::ofstream ofs (temporaryName.str ().c_str (), std::ofstream::out | std::ofstream::trunc);
+  ofs << "point\tsurname\tRngRun";
+  for (uint32_t i = 0; i < metrics.size (); i++)
+    ofs << "\t" << metrics[i].name;
+  ofs << "\n";
+  ofs << point << "\t" << surname << "\t" << run;
+  ofs << std::setprecision (std::numeric_limits<double>::max_digits10);
+  for (uint32_t i = 0; i < metrics.size (); i++) {
+    ofs << "\t";
+    if (metrics[i].valid)
+      ofs << metrics[i].value;
+  }
+  ofs << "\n";
+  ofs.close ();
+
+  if (!ofs || (std::rename (temporaryName.str ().c_str (), fileName.c_str ()) != 0)) {
+    std::cout << "ERROR: the results could not be written to " << fileName << "\n";
+    std::remove (temporaryName.str ().c_str ());
+  }
+}
+
+
 // this class stores a number of records: each one contains a pair AP node id - AP MAC address
 // the node id is the one given by ns3 when creating the node
 class AP_record
@@ -1173,9 +2711,29 @@ class AP_record
     uint8_t apWirelessChannel; 
 };
 
-typedef std::vector <AP_record * > AP_recordVector;
+// the records of all the APs, one after the other. The AP with id 'i' is AP_vector[i]
+typedef std::vector <AP_record> AP_recordVector;
 AP_recordVector AP_vector;
 
+// hash of a MAC address, so it can be used as the key of an unordered_map
+struct Mac48AddressHash
+{
+  std::size_t operator() (const Mac48Address &thisMac) const
+  {
+    uint8_t buffer[6];
+    thisMac.CopyTo (buffer);
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < 6; i++)
+      value = (value << 8) | buffer[i];
+    return std::hash<uint64_t> () (value);
+  }
+};
+
+// index of the APs by MAC address: it returns the id of the AP
+// the index by id is AP_vector itself, because the AP with id 'i' is stored in AP_vector[i]
+typedef std::unordered_map <Mac48Address, uint16_t, Mac48AddressHash> AP_macIndexMap;
+AP_macIndexMap AP_macIndex;
+
 AP_record::AP_record ()
 {
   apId = 0;
@@ -1219,121 +2777,237 @@ AP_record::setWirelessChannel(uint8_t thisWirelessChannel)
   apWirelessChannel = thisWirelessChannel;
 }
 
-// obtain the nearest AP of a STA, in a certain frequency band (2.4 or 5 GHz)
-// if 'frequencyBand == 0', the nearest AP will be searched in both bands
-static Ptr<Node>
-nearestAp (NodeContainer APs, Ptr<Node> mySTA, int myverbose, std::string frequencyBand)
+// Static index of the positions of the APs, used by nearestAp() instead of checking all the APs
+// The APs are put in the cells of a uniform grid, covering the area where the APs are
+// There is an index for each band (BAND_2_4GHZ and BAND_5GHZ), and another one for BAND_BOTH
+// The APs do not move, so the index is built once, after the channels of all the APs have been set
+class AP_spatialGrid
 {
-  // the frequency band MUST be "2.4 GHz" or "5 GHz". It can also be "both", meaning both bands
-  NS_ASSERT (( frequencyBand == "2.4 GHz" ) || (frequencyBand == "5 GHz" ) || (frequencyBand == "both" ));
+  public:
+    AP_spatialGrid ();
+    void Build (NodeContainer APs, WifiBand frequencyBand);
+    bool IsBuilt ();
+    uint32_t GetNumberAPs ();
+    int32_t Nearest (Vector position, double *distance); // position of the nearest AP in the NodeContainer. -1 if there is none
 
-  // vector with the position of the STA
-  Vector posSta = GetPosition (mySTA);
+  private:
+    struct gridAP {
+      uint32_t index; // position of the AP in the NodeContainer (and in AP_vector)
+      double x;
+      double y;
+    };
+    bool built;
+    uint32_t numberAPs;
+    double xMin;
+    double yMin;
+    double cellSize;
+    int32_t numCellsX;
+    int32_t numCellsY;
+    std::vector< std::vector<gridAP> > cells;
+};
 
-  if (frequencyBand != "both") {
-    //if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << "\n"
-                << Simulator::Now().GetSeconds() 
-                << "\t[nearestAp] Looking for the nearest AP of STA #" << mySTA->GetId()
-                << ", in position: "  << posSta.x << "," << posSta.y
-                << ", in the " << frequencyBand << " band"
-                << std::endl;
-  }
-  else {
-    //if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << "\n"
-                << Simulator::Now().GetSeconds() 
-                << "\t[nearestAp] Looking for the nearest AP of STA #" << mySTA->GetId()
-                << ", in position: "  << posSta.x << "," << posSta.y
-                << ", in any frequency band"
-                << std::endl;    
+AP_spatialGrid::AP_spatialGrid ()
+{
+  built = false;
+  numberAPs = 0;
+  xMin = 0.0;
+  yMin = 0.0;
+  cellSize = 1.0;
+  numCellsX = 0;
+  numCellsY = 0;
+}
+
+void
+AP_spatialGrid::Build (NodeContainer APs, WifiBand frequencyBand)
+{
+  // the APs of the NodeContainer and the ones in AP_vector go in the same order
+  std::vector<gridAP> members;
+  AP_recordVector::iterator indexAP = AP_vector.begin ();
+  uint32_t index = 0;
+  for (NodeContainer::Iterator i = APs.Begin (); i != APs.End (); ++i, ++indexAP, ++index) {
+    if (getWirelessBandOfChannel(indexAP->GetWirelessChannel()) & frequencyBand) {
+      Vector posAp = GetPosition (*i);
+      gridAP thisAP = { index, posAp.x, posAp.y };
+      members.push_back (thisAP);
+    }
+  }
+
+  built = true;
+  numberAPs = members.size ();
+  cells.clear ();
+  numCellsX = 0;
+  numCellsY = 0;
+  if (members.empty ())
+    return;
+
+  // area covered by the APs
+  xMin = members[0].x;
+  yMin = members[0].y;
+  double xMax = xMin;
+  double yMax = yMin;
+  for (uint32_t j = 0; j < members.size (); j++) {
+    xMin = std::min (xMin, members[j].x);
+    yMin = std::min (yMin, members[j].y);
+    xMax = std::max (xMax, members[j].x);
+    yMax = std::max (yMax, members[j].y);
+  }
+
+  // about one AP per cell. In the regular topologies, this is the distance between APs
+  uint32_t cellsPerSide = std::max (1, (int) ceil (sqrt ((double) members.size ())));
+  cellSize = std::max (xMax - xMin, yMax - yMin) / cellsPerSide;
+  if (cellSize <= 0.0)
+    cellSize = 1.0; // all the APs are in the same place
+
+  numCellsX = (int32_t) floor ((xMax - xMin) / cellSize) + 1;
+  numCellsY = (int32_t) floor ((yMax - yMin) / cellSize) + 1;
+  cells.resize (numCellsX * numCellsY);
+
+  // the APs are added in order, so each cell is sorted by index
+  for (uint32_t j = 0; j < members.size (); j++) {
+    int32_t cx = std::min (numCellsX - 1, (int32_t) floor ((members[j].x - xMin) / cellSize));
+    int32_t cy = std::min (numCellsY - 1, (int32_t) floor ((members[j].y - yMin) / cellSize));
+    cells[cy * numCellsX + cx].push_back (members[j]);
   }
+}
 
-  // calculate an initial value for the minimum distance (a very high value)
-  double mimimumDistance = APs.GetN() * 100000;
+bool
+AP_spatialGrid::IsBuilt ()
+{
+  return built;
+}
 
-  uint8_t channelNearestAP = 0;
+uint32_t
+AP_spatialGrid::GetNumberAPs ()
+{
+  return numberAPs;
+}
 
-  // variable for storing the nearest AP
-  Ptr<Node> nearest;
+// The cells are visited in rings around the one of the STA, and the search stops when
+// the nearest AP found is nearer than any AP of the next ring
+// If two APs are at the same distance, the first one in the NodeContainer is returned, as the linear search did
+int32_t
+AP_spatialGrid::Nearest (Vector position, double *distance)
+{
+  if (numberAPs == 0)
+    return -1;
+
+  // the STA may be out of the area covered by the APs: start from the closest cell
+  int32_t cx = (int32_t) floor ((position.x - xMin) / cellSize);
+  int32_t cy = (int32_t) floor ((position.y - yMin) / cellSize);
+  cx = std::max (0, std::min (numCellsX - 1, cx));
+  cy = std::max (0, std::min (numCellsY - 1, cy));
+
+  int32_t nearest = -1;
+  double minimumDistance = 0.0;
+  int32_t maxRing = std::max (numCellsX, numCellsY);
+
+  for (int32_t ring = 0; ring <= maxRing; ring++) {
+    for (int32_t y = cy - ring; y <= cy + ring; y++) {
+      if ((y < 0) || (y >= numCellsY))
+        continue;
+      // in the first and the last row of the ring all the cells are visited, in the others only the two ends
+      int32_t step = ((y == cy - ring) || (y == cy + ring)) ? 1 : std::max (1, 2 * ring);
+      for (int32_t x = cx - ring; x <= cx + ring; x += step) {
+        if ((x < 0) || (x >= numCellsX))
+          continue;
+        std::vector<gridAP> &cell = cells[y * numCellsX + x];
+        for (uint32_t j = 0; j < cell.size (); j++) {
+          double thisDistance = sqrt ( ( (position.x - cell[j].x)*(position.x - cell[j].x) ) + ( (position.y - cell[j].y)*(position.y - cell[j].y) ) );
+          if ( (nearest == -1)
+              || (thisDistance < minimumDistance)
+              || ((thisDistance == minimumDistance) && ((int32_t)cell[j].index < nearest)) ) {
+            minimumDistance = thisDistance;
+            nearest = cell[j].index;
+          }
+        }
+      }
+    }
+    // the APs of the next rings are, at least, 'ring * cellSize' away
+    if ((nearest != -1) && (minimumDistance < ring * cellSize))
+      break;
+  }
 
-  // vector with the position of the AP
-  Vector posAp;
+  if (distance != NULL)
+    *distance = minimumDistance;
+  return nearest;
+}
 
-  // Check all the APs to find the nearest one
-  // go through the AP record vector
-  AP_recordVector::const_iterator indexAP = AP_vector.begin ();
+AP_spatialGrid AP_grid2_4GHz;
+AP_spatialGrid AP_grid5GHz;
+AP_spatialGrid AP_gridBothBands;
 
-  // go through the nodeContainer of APs at the same time
-  NodeContainer::Iterator i; 
-  for (i = APs.Begin (); i != APs.End (); ++i)
-  {
-    //(*i)->method ();  // some Node method
+// build the three views of the index. To be called when the APs have their position and their channel
+void
+BuildAP_spatialIndex (NodeContainer APs)
+{
+  AP_grid2_4GHz.Build (APs, BAND_2_4GHZ);
+  AP_grid5GHz.Build (APs, BAND_5GHZ);
+  AP_gridBothBands.Build (APs, BAND_BOTH);
+}
 
-    // find the frequency band of this AP
-    uint8_t channelThisAP = (*indexAP)->GetWirelessChannel();
-    std::string frequencyBandThisAP = getWirelessBandOfChannel(channelThisAP);
+// obtain the nearest AP of a STA, in a certain frequency band (2.4 or 5 GHz)
+// if 'frequencyBand == BAND_BOTH', the nearest AP will be searched in both bands
+static Ptr<Node>
+nearestAp (const NodeContainer& APs, Ptr<Node> mySTA, int myverbose, WifiBand frequencyBand)
+{
+  // the frequency band MUST be BAND_2_4GHZ or BAND_5GHZ. It can also be BAND_BOTH, meaning both bands
+  NS_ASSERT (( frequencyBand == BAND_2_4GHZ ) || (frequencyBand == BAND_5GHZ ) || (frequencyBand == BAND_BOTH ));
 
-    if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now().GetSeconds() 
-                << "\t[nearestAp]\tAP #" << (*i)->GetId()
-                <<  ", channel: "  << (int)channelThisAP 
-                << ", frequency band: " << frequencyBandThisAP << std::endl;
+  // vector with the position of the STA
+  Vector posSta = GetPosition (mySTA);
 
-    // only look for APs in the specified frequency band
-    if ((frequencyBand == frequencyBandThisAP ) || (frequencyBand == "both") ) {
-      if (VERBOSE_FOR_DEBUG > 0)
-        std::cout << "\t\t\t is in the correct band" << std::endl;
+  if (LOG_ENABLED (3, myverbose)) {
+    std::cout << "\n"
+              << Simulator::Now().GetSeconds() 
+              << "\t[nearestAp] Looking for the nearest AP of STA #" << mySTA->GetId()
+              << ", in position: "  << posSta.x << "," << posSta.y;
+    if (frequencyBand != BAND_BOTH)
+      std::cout << ", in the " << frequencyBand << " band" << std::endl;
+    else
+      std::cout << ", in any frequency band" << std::endl;
+  }
+
+  // select the view of the index for this band
+  AP_spatialGrid *grid;
+  if (frequencyBand == BAND_2_4GHZ)
+    grid = &AP_grid2_4GHz;
+  else if (frequencyBand == BAND_5GHZ)
+    grid = &AP_grid5GHz;
+  else
+    grid = &AP_gridBothBands;
 
-      posAp = GetPosition((*i));
-      double distance = sqrt ( ( (posSta.x - posAp.x)*(posSta.x - posAp.x) ) + ( (posSta.y - posAp.y)*(posSta.y - posAp.y) ) );
-      if (distance < mimimumDistance ) {
-        mimimumDistance = distance;
-        nearest = *i;
-        channelNearestAP = channelThisAP;
+  // the index is built in main(), once the APs are defined. This is just in case it has not been built yet
+  if (!grid->IsBuilt ())
+    grid->Build (APs, frequencyBand);
 
-        if (VERBOSE_FOR_DEBUG > 0)
-          std::cout << "\t\t\t and it is the nearest one so far (distance " << distance << " m)" << std::endl;
-      }
-      else {
-        if (VERBOSE_FOR_DEBUG > 0)
-          std::cout << "\t\t\t but it is not the nearest one (distance " << distance << " m)" << std::endl;
-      }
-    }
-    else {
-      if (VERBOSE_FOR_DEBUG > 0)
-        std::cout << "\t\t\t is not in the correct band" << std::endl;      
-    }
-    indexAP++;
-  }
+  double minimumDistance;
+  int32_t nearestIndex = grid->Nearest (posSta, &minimumDistance);
+
+  // variable for storing the nearest AP
+  Ptr<Node> nearest;
 
-  if(nearest!=NULL) {
+  if (nearestIndex != -1) {
+    nearest = APs.Get (nearestIndex);
+    uint8_t channelNearestAP = AP_vector[nearestIndex].GetWirelessChannel();
     NS_ASSERT(channelNearestAP!=0);
-    if (frequencyBand != "both") {
-     //if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now().GetSeconds()
-                << "\t[nearestAp] Result: The nearest AP in the " << frequencyBand << " band "
-                << "is AP#" << nearest->GetId() 
-                << ". Channel: "  << (int)channelNearestAP 
-                << ". Frequency band: " << getWirelessBandOfChannel(channelNearestAP)
-                << ". Position: "  << GetPosition((nearest)).x 
-                << "," << GetPosition((nearest)).y
-                << std::endl;     
-    }
-    else {
-      //if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now().GetSeconds()
-                << "\t[nearestAp] Result: The nearest AP in any frequency band "
-                << "is AP#" << nearest->GetId() 
+
+    if (LOG_ENABLED (3, myverbose)) {
+      std::cout << Simulator::Now().GetSeconds();
+      if (frequencyBand != BAND_BOTH)
+        std::cout << "\t[nearestAp] Result: The nearest AP in the " << frequencyBand << " band ";
+      else
+        std::cout << "\t[nearestAp] Result: The nearest AP in any frequency band ";
+      std::cout << "is AP#" << nearest->GetId() 
                 << ". Channel: "  << (int)channelNearestAP 
                 << ". Frequency band: " << getWirelessBandOfChannel(channelNearestAP)
                 << ". Position: "  << GetPosition((nearest)).x 
                 << "," << GetPosition((nearest)).y
-                << std::endl;        
+                << ". Distance: " << minimumDistance << " m"
+                << std::endl;
     }
   }
   else {
-    if (frequencyBand != "both") {
+    if (frequencyBand != BAND_BOTH) {
       // if an AP in the same band cannot be found, finish the simulation
       std::cout << Simulator::Now().GetSeconds()
                 << "\t[nearestAp] Result: There is no AP in the " << frequencyBand << " band "
@@ -1363,17 +3037,27 @@ AP_record::GetMaxSizeAmpdu ()
   return apMaxSizeAmpdu;
 }
 
+// returns the record of an AP. The AP with id 'i' is stored in AP_vector[i]
+AP_record*
+GetAP_record (uint16_t thisAPid)
+{
+  NS_ASSERT (thisAPid < AP_vector.size ());
+  NS_ASSERT (AP_vector[thisAPid].GetApid () == thisAPid);
+  return &AP_vector[thisAPid];
+}
+
+// add the MAC address of an AP to the index of APs
 void
-Modify_AP_Record (uint16_t thisId, std::string thisMac, uint32_t thisMaxSizeAmpdu) // FIXME: Can this be done just with Set_AP_Record?
+Register_AP_Mac (uint16_t thisId, Mac48Address thisMac)
 {
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
-    //std::cout << Simulator::Now ().GetSeconds() << " ********************** AP with ID " << (*index)->GetApid() << " has MAC: " << (*index)->GetMac() << " *****" << std::endl;
+  AP_macIndex[thisMac] = thisId;
+}
 
-    if ( (*index)->GetMac () == thisMac ) {
-      (*index)->SetApRecord (thisId, thisMac, thisMaxSizeAmpdu);
-      //std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] AP #" << (*index)->GetApid() << " has MAC: " << (*index)->GetMac() << "" << std::endl;
-    }
-  }
+void
+Modify_AP_Record (uint16_t thisId, std::string thisMac, uint32_t thisMaxSizeAmpdu) // FIXME: Can this be done just with Set_AP_Record?
+{
+  NS_ASSERT (GetAP_record (thisId)->GetMac () == thisMac);
+  GetAP_record (thisId)->SetApRecord (thisId, thisMac, thisMaxSizeAmpdu);
 }
 
 
@@ -1381,7 +3065,7 @@ uint32_t
 CountAPs ()
 {
   uint32_t number = 0;
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+  for (AP_recordVector::iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
     number ++;
   }
   return number;
@@ -1391,12 +3075,12 @@ uint32_t
 CountAPs (uint32_t myverbose)
 // counts all the APs with their id, mac and current value of MaxAmpdu
 {
-  if (myverbose > 2)
+  if (LOG_ENABLED (3, myverbose))
     std::cout << "\n" << Simulator::Now ().GetSeconds() << "   \t[CountAPs] Report APs" << std::endl;
 
   uint32_t number = 0;
 
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+  for (AP_recordVector::iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
     number ++;
   }
   return number;
@@ -1404,45 +3088,29 @@ CountAPs (uint32_t myverbose)
 
 
 uint16_t
-GetAnAP_Id (std::string thisMac)
-// lists all the STAs associated to an AP, with the MAC of the AP
+GetAnAP_Id (Mac48Address thisMac)
+// returns the id of the AP with a MAC address
 {
   if (VERBOSE_FOR_DEBUG > 0)
     std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] Looking for MAC " << thisMac << std::endl;
 
-  bool macFound = false;
-
-  uint16_t APid;
-
-  uint32_t numberAPs = CountAPs();
-  if (VERBOSE_FOR_DEBUG > 0)
-    std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] Number of APs: " << (unsigned int)numberAPs << "\n";
-  //std::cout << Simulator::Now ().GetSeconds() << " *** Number of STA associated: " << Get_STA_record_num() << " *****" << std::endl;
-
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
-    if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id]   AP with ID " << (*index)->GetApid() << " has MAC:   " << (*index)->GetMac() << std::endl;
-    
-    if ( (*index)->GetMac () == thisMac ) {
-      // check the primary MAC address of each AP
-      APid = (*index)->GetApid ();
-      macFound = true;
-      if (VERBOSE_FOR_DEBUG > 0)
-        std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] FOUND: AP #" << (*index)->GetApid() << " has MAC: " << (*index)->GetMac() << "" << std::endl;
-    }
-  }
+  AP_macIndexMap::const_iterator index = AP_macIndex.find (thisMac);
 
   // make sure that an AP with 'thisMac' exists
-  if (macFound == false) {
+  if (index == AP_macIndex.end ()) {
     std::cout << "\n"
               << Simulator::Now ().GetSeconds()
               << "\t[GetAnAP_Id] ERROR: MAC " << thisMac << " not found in the list of APs. Stopping simulation"
               << std::endl;
-    NS_ASSERT(macFound == true);
+    NS_ASSERT(index != AP_macIndex.end ());
+    return 0;
   }
-  
+
+  if (VERBOSE_FOR_DEBUG > 0)
+    std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] FOUND: AP #" << index->second << " has MAC: " << thisMac << "" << std::endl;
+
   // return the identifier of the AP
-  return APid;
+  return index->second;
 }
 
 
@@ -1450,20 +3118,14 @@ uint32_t
 GetAP_MaxSizeAmpdu (uint16_t thisAPid, uint32_t myverbose)
 // returns the max size of the Ampdu of an AP
 {
-  uint32_t APMaxSizeAmpdu = 0;
-  //std::cout << Simulator::Now ().GetSeconds() << " *** Number of STA associated: " << Get_STA_record_num() << " *****" << std::endl;
+  uint32_t APMaxSizeAmpdu = GetAP_record (thisAPid)->GetMaxSizeAmpdu ();
 
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+  if ( LOG_ENABLED (3, myverbose) )
+    std::cout << Simulator::Now ().GetSeconds() 
+              << "\t[GetAP_MaxSizeAmpdu] AP #" << thisAPid 
+              << " has AMDPU: " << APMaxSizeAmpdu 
+              << "" << std::endl;
 
-    if ( (*index)->GetApid () == thisAPid ) {
-      APMaxSizeAmpdu = (*index)->GetMaxSizeAmpdu ();
-      if ( myverbose > 2 )
-        std::cout << Simulator::Now ().GetSeconds() 
-                  << "\t[GetAP_MaxSizeAmpdu] AP #" << (*index)->GetApid() 
-                  << " has AMDPU: " << (*index)->GetMaxSizeAmpdu() 
-                  << "" << std::endl;
-    }
-  }
   return APMaxSizeAmpdu;
 }
 
@@ -1471,20 +3133,14 @@ uint8_t
 GetAP_WirelessChannel (uint16_t thisAPid, uint32_t myverbose)
 // returns the wireless channel of an AP
 {
-  uint8_t APWirelessChannel = 0;
-  //std::cout << Simulator::Now ().GetSeconds() << " *** Number of STA associated: " << Get_STA_record_num() << " *****" << std::endl;
+  uint8_t APWirelessChannel = GetAP_record (thisAPid)->GetWirelessChannel ();
 
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+  if ( LOG_ENABLED (3, myverbose) )
+    std::cout << Simulator::Now ().GetSeconds() 
+              << "\t[GetAP_WirelessChannel] AP #" << thisAPid 
+              << " has channel: " << uint16_t(APWirelessChannel)
+              << "" << std::endl;
 
-    if ( (*index)->GetApid () == thisAPid ) {
-      APWirelessChannel = (*index)->GetWirelessChannel();
-      if ( myverbose > 2 )
-        std::cout << Simulator::Now ().GetSeconds() 
-                  << "\t[GetAP_WirelessChannel] AP #" << (*index)->GetApid() 
-                  << " has channel: " << uint16_t((*index)->GetWirelessChannel())
-                  << "" << std::endl;
-    }
-  }
   return APWirelessChannel;
 }
 
@@ -1495,13 +3151,13 @@ ListAPs (uint32_t myverbose)
 {
   std::cout << "\n" << Simulator::Now ().GetSeconds() << "   \t[ListAPs] Report APs. Total " << CountAPs(myverbose) << " APs" << std::endl;
 
-  for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+  for (AP_recordVector::iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
     std::cout //<< Simulator::Now ().GetSeconds()
               << "                  "
-              << "   \t\tAP #" << (*index)->GetApid() 
-              << " with MAC " << (*index)->GetMac() 
-              << " Max size AMPDU " << (*index)->GetMaxSizeAmpdu() 
-              << " Channel " << uint16_t((*index)->GetWirelessChannel())
+              << "   \t\tAP #" << index->GetApid() 
+              << " with MAC " << index->GetMac() 
+              << " Max size AMPDU " << index->GetMaxSizeAmpdu() 
+              << " Channel " << uint16_t(index->GetWirelessChannel())
               << std::endl;
   }
   std::cout << std::endl;
@@ -1514,6 +3170,40 @@ ListAPs (uint32_t myverbose)
 // - the information of its association: the MAC of the AP where it is associated
 // - the type of application it is running
 // note: it does NOT store the MAC address of the STA itself
+// the settings of the STAs that are the same for all of them in a run. They are stored once, instead of in each STA_record
+struct STA_settings
+{
+  STA_settings ();
+  uint32_t verboseLevel;
+  uint32_t numOperationalChannels;
+  int numberWiFiCards;
+  Wifi80211Version version80211primary;
+  Wifi80211Version version80211Secondary;
+  WifiBand bandsSupported;    // obtained from the number of cards and their versions
+  uint16_t aggregationDisableAlgorithm;
+  uint32_t maxAmpduSize;
+  uint32_t maxAmpduSizeWhenAggregationLimited;
+  uint32_t wifiModel;
+};
+
+STA_settings::STA_settings ()
+{
+  verboseLevel = 0;
+  numOperationalChannels = 0;
+  numberWiFiCards = 1;
+  version80211primary = VERSION_UNKNOWN;
+  version80211Secondary = VERSION_UNKNOWN;
+  bandsSupported = BAND_NONE;
+  aggregationDisableAlgorithm = 0;
+  maxAmpduSize = 0;
+  maxAmpduSizeWhenAggregationLimited = 0;
+  wifiModel = 0;
+}
+
+STA_settings staSettings;
+
+// The state of a STA. The records of all the STAs are stored together in assoc_vector, so the loops
+// that go through all of them read consecutive memory. The members are ordered by size, so a record takes 20 bytes
 class STA_record
 {
   public:
@@ -1523,62 +3213,42 @@ class STA_record
     Mac48Address GetMacOfitsAP ();
     uint32_t Gettypeofapplication ();
     uint32_t GetMaxSizeAmpdu ();
+    uint16_t GetMemberOfAP ();
     void SetAssoc (std::string context, Mac48Address AP_MAC_address);
     void UnsetAssoc (std::string context, Mac48Address AP_MAC_address);
     void setstaid (uint16_t id);
     void Settypeofapplication (uint32_t applicationid);
     void SetMaxSizeAmpdu (uint32_t MaxSizeAmpdu);
-    void SetVerboseLevel (uint32_t myVerboseLevel);
-    void SetnumOperationalChannels (uint32_t mynumOperationalChannels);
-    void SetstaRecordNumberWiFiCards (int mynumWiFiCards);
-    void Setversion80211primary (std::string myversion80211);
-    void Setversion80211Secondary (std::string myversion80211);
+    void SetMemberOfAP (uint16_t thisAPid);
     void activatePrimaryCard();
     void activateSecondaryCard();
     void deactivatePrimaryCard();
     void deactivateSecondaryCard();
-    void SetaggregationDisableAlgorithm (uint16_t myaggregationDisableAlgorithm);
-    void SetAmpduSize (uint32_t myAmpduSize);
-    void SetmaxAmpduSizeWhenAggregationLimited (uint32_t mymaxAmpduSizeWhenAggregationLimited);
-    void SetWifiModel (uint32_t mywifiModel);
   private:
-    bool assoc;
+    uint32_t staRecordMaxSizeAmpdu;
     uint16_t staid;
+    uint16_t memberOfAP;        // id of the AP in whose lists (AP_members) the STA is, or NO_AP
     Mac48Address apMac;
-    uint32_t typeofapplication; // 0 no application; 1 VoIP upload; 2 VoIP download; 3 TCP upload; 4 TCP download; 5 Video download
-    uint32_t staRecordMaxSizeAmpdu;
-    uint32_t staRecordVerboseLevel;
-    uint32_t staRecordnumOperationalChannels;
-    int staRecordNumberWiFiCards;
-    std::string staRecordversion80211primary;
-    std::string staRecordVersion80211Secondary;
+    uint8_t typeofapplication;  // 0 no application; 1 VoIP upload; 2 VoIP download; 3 TCP upload; 4 TCP download; 5 Video download
+    bool assoc;
     bool staRecordPrimaryCardActive;
     bool staRecordSecondaryCardActive;
-    uint16_t staRecordaggregationDisableAlgorithm;
-    uint32_t staRecordMaxAmpduSize;
-    uint32_t staRecordmaxAmpduSizeWhenAggregationLimited;
-    uint32_t staRecordwifiModel;
 };
 
+// value of memberOfAP when the STA is not in the lists of any AP
+const uint16_t NO_AP = 0xFFFF;
+
 // this is the constructor. Set the default parameters
 STA_record::STA_record ()
 {
   assoc = false;
   staid = 0;
+  memberOfAP = NO_AP;
   apMac = "00:00:00:00:00:00";    //MAC address of the AP to which the STA is associated
   typeofapplication = 0;
   staRecordMaxSizeAmpdu = 0;
-  staRecordVerboseLevel = 0;
-  staRecordnumOperationalChannels = 0;
-  staRecordNumberWiFiCards = 1;
-  staRecordversion80211primary = "";
-  staRecordVersion80211Secondary = "";
   staRecordPrimaryCardActive = false;    // FIXME: maybe this is not needed and ns3 can store it
   staRecordSecondaryCardActive = false;  // FIXME: maybe this is not needed and ns3 can store it
-  staRecordaggregationDisableAlgorithm = 0;
-  staRecordMaxAmpduSize = 0;
-  staRecordmaxAmpduSizeWhenAggregationLimited = 0;
-  staRecordwifiModel = 0;
 }
 
 void
@@ -1587,9 +3257,65 @@ STA_record::setstaid (uint16_t id)
   staid = id;
 }
 
-typedef std::vector <STA_record * > STA_recordVector;
+// the records of all the STAs. The space for all of them is reserved before the first one is added, so they
+// never move: the callbacks of association and the lists of the APs keep pointers to them
+typedef std::vector <STA_record> STA_recordVector;
 STA_recordVector assoc_vector;
 
+typedef std::vector <STA_record * > STA_recordList;
+
+// index of the STAs associated to each AP. It is updated by SetAssoc and UnsetAssoc,
+// so the STAs of an AP can be found without going through the whole assoc_vector
+// Each list is kept in the order of assoc_vector (the records never move, so this is the order of the pointers),
+// so the STAs are visited, and written to the output files, in the same order as when assoc_vector was scanned
+struct AP_members
+{
+  STA_recordList VoIP;  // STAs running VoIP (applications 1 and 2)
+  STA_recordList bulk;  // STAs running TCP or video (applications 3, 4 and 5)
+};
+
+std::vector <AP_members> AP_membersVector;              // the STAs of the AP with id 'i' are in AP_membersVector[i]
+
+// returns the lists of STAs associated to an AP
+AP_members&
+Get_AP_members (uint16_t thisAPid)
+{
+  if (thisAPid >= AP_membersVector.size ())
+    AP_membersVector.resize (thisAPid + 1);
+  return AP_membersVector[thisAPid];
+}
+
+// remove a STA from the lists of its AP
+void
+Remove_AP_member (STA_record* thisSTA)
+{
+  uint16_t thisAPid = thisSTA->GetMemberOfAP ();
+  if (thisAPid == NO_AP)
+    return;
+
+  STA_recordList& members = ( thisSTA->Gettypeofapplication () <= 2 ) ? Get_AP_members (thisAPid).VoIP : Get_AP_members (thisAPid).bulk;
+  STA_recordList::iterator position = std::find (members.begin (), members.end (), thisSTA);
+  NS_ASSERT (position != members.end ());
+
+  members.erase (position);
+  thisSTA->SetMemberOfAP (NO_AP);
+}
+
+// add a STA to the lists of an AP. A STA can only be in the lists of one AP
+void
+Add_AP_member (uint16_t thisAPid, STA_record* thisSTA)
+{
+  Remove_AP_member (thisSTA);
+
+  // STAs without application are not added
+  if ( thisSTA->Gettypeofapplication () == 0 )
+    return;
+
+  STA_recordList& members = ( thisSTA->Gettypeofapplication () <= 2 ) ? Get_AP_members (thisAPid).VoIP : Get_AP_members (thisAPid).bulk;
+  members.insert (std::lower_bound (members.begin (), members.end (), thisSTA), thisSTA);
+  thisSTA->SetMemberOfAP (thisAPid);
+}
+
 void
 STA_record::activatePrimaryCard()
 {
@@ -1619,8 +3345,8 @@ Get_STA_record_num ()
 // counts the number or STAs associated
 {
   uint32_t AssocNum = 0;
-  for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-    if ((*index)->GetAssoc ()) {
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+    if (index->GetAssoc ()) {
       AssocNum++;
     }
   }
@@ -1637,30 +3363,24 @@ GetChannelOfAnSTA (uint16_t id)
               << std::endl;
 
   uint8_t channel = 0;
-  for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-    if ((*index)->GetStaid () == id) {
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+    if (index->GetStaid () == id) {
 
       Mac48Address nullMAC = "00:00:00:00:00:00";
 
-      if ((*index)->GetMacOfitsAP() == nullMAC) {
+      if (index->GetMacOfitsAP() == nullMAC) {
         if (VERBOSE_FOR_DEBUG > 0)
             std::cout << Simulator::Now().GetSeconds()
-                      << "\t[GetChannelOfAnSTA] STA #" << (*index)->GetStaid ()
+                      << "\t[GetChannelOfAnSTA] STA #" << index->GetStaid ()
                       << " nas no associated AP"
                       << std::endl;
       }
       else {
-        // auxiliar string
-        std::ostringstream auxString;
-        // create a string with the MAC
-        auxString << "02-06-" << (*index)->GetMacOfitsAP();
-        std::string myaddress = auxString.str();
-
         if (VERBOSE_FOR_DEBUG > 0)
           std::cout << Simulator::Now().GetSeconds()
-                    << "\t[GetChannelOfAnSTA] STA with Id" << (*index)->GetStaid ()
+                    << "\t[GetChannelOfAnSTA] STA with Id" << index->GetStaid ()
                     << " found"
-                    << ". MAC of its associated AP: " << myaddress
+                    << ". MAC of its associated AP: " << index->GetMacOfitsAP()
                     << std::endl; 
 
         if (VERBOSE_FOR_DEBUG > 0)
@@ -1669,8 +3389,7 @@ GetChannelOfAnSTA (uint16_t id)
                     << std::endl;
 
         // Get the wireless channel of the AP with the corresponding address
-        NS_ASSERT(myaddress!="02-06-00:00:00:00:00:00");
-        channel = GetAP_WirelessChannel (GetAnAP_Id(myaddress), 0);      
+        channel = GetAP_WirelessChannel (GetAnAP_Id(index->GetMacOfitsAP()), 0);
       }
     }
   }
@@ -1683,40 +3402,49 @@ GetChannelOfAnSTA (uint16_t id)
 }
 
 // Print the channel of a STA
-static void
-ReportChannel (double period, uint16_t id, int myverbose)
+class ReportChannelTask : public PeriodicTask
+{
+  public:
+    ReportChannelTask (uint16_t thisId, int thisVerbose);
+  protected:
+    void Run ();
+    std::string GetName () const { return "ReportChannel"; }
+  private:
+    uint16_t id;
+    int myverbose;
+};
+
+ReportChannelTask::ReportChannelTask (uint16_t thisId, int thisVerbose)
+{
+  id = thisId;
+  myverbose = thisVerbose;
+}
+
+void
+ReportChannelTask::Run ()
 {
-  if (myverbose > 2) {
+  if (LOG_ENABLED (3, myverbose)) {
     // Find the AP to which the STA is associated
-    for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-      if ((*index)->GetStaid () == id) {
-        // auxiliar string
-        std::ostringstream auxString;
-        // create a string with the MAC
-        auxString << "02-06-" << (*index)->GetMacOfitsAP();
-        std::string myaddress = auxString.str();
-        NS_ASSERT(!myaddress.empty());
-
-        if (myaddress=="02-06-00:00:00:00:00:00") {
+    for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+      if (index->GetStaid () == id) {
+        Mac48Address nullMAC = "00:00:00:00:00:00";
+
+        if (index->GetMacOfitsAP() == nullMAC) {
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ReportChannel] STA #" << id 
                     << " Not associated to any AP"
                     << std::endl;          
         }
         else {
-          NS_ASSERT(myaddress!="02-06-00:00:00:00:00:00");
           std::cout << Simulator::Now().GetSeconds()
                     << "\t[ReportChannel] STA #" << id 
-                    << " Associated to AP#" << GetAnAP_Id(myaddress)
+                    << " Associated to AP#" << GetAnAP_Id(index->GetMacOfitsAP())
                     << ". Channel: " << uint16_t(GetChannelOfAnSTA (id))
                     << std::endl;          
         }
       }
     }
   }
-
-  // re-schedule
-  Simulator::Schedule (Seconds (period), &ReportChannel, period, id, myverbose);
 }
 
 // lists all the STAs, with the MAC of the AP if they are associated to it
@@ -1725,15 +3453,8 @@ List_STA_record ()
 {
   std::cout << "\n" << Simulator::Now ().GetSeconds() << "\t[List_STA_record] Report STAs. Total associated: " << Get_STA_record_num() << "" << std::endl;
 
-  for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-    if ((*index)->GetAssoc ()) {
-
-      // auxiliar string
-      std::ostringstream auxString;
-      // create a string with the MAC
-      auxString << "02-06-" << (*index)->GetMacOfitsAP();
-      std::string myaddress = auxString.str();
-      NS_ASSERT(!myaddress.empty());
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+    if (index->GetAssoc ()) {
 
       if (VERBOSE_FOR_DEBUG > 0)
         std::cout << Simulator::Now().GetSeconds()
@@ -1741,18 +3462,18 @@ List_STA_record ()
                   << std::endl; 
 
       std::cout //<< Simulator::Now ().GetSeconds() 
-                << "\t\t\t\tSTA #" << (*index)->GetStaid() 
-                << "\tassociated to AP #" << GetAnAP_Id(myaddress) 
-                << "\twith MAC " << (*index)->GetMacOfitsAP() 
-                << "\ttype of application " << (*index)->Gettypeofapplication()
-                << "\tValue of Max AMPDU " << (*index)->GetMaxSizeAmpdu()
+                << "\t\t\t\tSTA #" << index->GetStaid() 
+                << "\tassociated to AP #" << GetAnAP_Id(index->GetMacOfitsAP()) 
+                << "\twith MAC " << index->GetMacOfitsAP() 
+                << "\ttype of application " << index->Gettypeofapplication()
+                << "\tValue of Max AMPDU " << index->GetMaxSizeAmpdu()
                 << std::endl;
     } else {
       std::cout //<< Simulator::Now ().GetSeconds() 
-                << "\t\t\t\tSTA #" << (*index)->GetStaid()
+                << "\t\t\t\tSTA #" << index->GetStaid()
                 << "\tnot associated to any AP \t\t\t" 
-                << "\ttype of application " << (*index)->Gettypeofapplication()
-                << "\tValue of Max AMPDU " << (*index)->GetMaxSizeAmpdu()
+                << "\ttype of application " << index->Gettypeofapplication()
+                << "\tValue of Max AMPDU " << index->GetMaxSizeAmpdu()
                 << std::endl;      
     }
   }
@@ -1762,6 +3483,9 @@ List_STA_record ()
 void
 STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
 {
+  static uint32_t profilerEntry = callbackProfiler.GetEntry ("SetAssoc");
+  ProfileScope profile (profilerEntry);
+
   // 'context' is something like "/NodeList/9/DeviceList/1/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/$ns3::StaWifiMac/Assoc"
   if(VERBOSE_FOR_DEBUG > 0)
     std::cout << "\t[SetAssoc] context: " << context << std::endl;
@@ -1777,35 +3501,34 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
   //  typeofapplication
   //  staRecordMaxSizeAmpdu
 
-  // auxiliar string
-  std::ostringstream auxString;
-  // create a string with the MAC
-  auxString << "02-06-" << AP_MAC_address;
-  std::string myaddress = auxString.str();
-
-  NS_ASSERT(!myaddress.empty());
-
   if (VERBOSE_FOR_DEBUG > 0)
     std::cout << Simulator::Now().GetSeconds()
               << "\t[SetAssoc] Calling GetAnAP_Id()"
               << std::endl;
 
-  uint32_t apId = GetAnAP_Id(myaddress);
+  uint32_t apId = GetAnAP_Id(AP_MAC_address);
+  TRACE_EVENT (TRACE_ASSOC, staid, apId, 0);
+
+  // the MAC of the AP, as it is stored in the list of APs
+  std::string myaddress = GetAP_record(apId)->GetMac();
 
-  uint8_t apChannel = GetAP_WirelessChannel ( apId, staRecordVerboseLevel );
+  // update the index of STAs of each AP
+  Add_AP_member (apId, this);
 
-  if (staRecordVerboseLevel > 0)
+  uint8_t apChannel = GetAP_WirelessChannel ( apId, staSettings.verboseLevel );
+
+  if (LOG_ENABLED (1, staSettings.verboseLevel))
     std::cout << Simulator::Now ().GetSeconds() 
               << "\t[SetAssoc] STA #" << staid 
               << "\twith AMPDU size " << staRecordMaxSizeAmpdu 
-              << "\trunning application " << typeofapplication 
+              << "\trunning application " << uint16_t (typeofapplication) 
               << "\thas associated to AP #" << apId
               << " with MAC " << apMac  
               << " with channel " <<  uint16_t (apChannel)
               << "" << std::endl;
 
   // This part only runs if the aggregation algorithm is activated
-  if (staRecordaggregationDisableAlgorithm == 1) {
+  if (staSettings.aggregationDisableAlgorithm == 1) {
     // check if the STA associated to the AP is running VoIP. In this case, I have to disable aggregation:
     // - in the AP
     // - in all the associated STAs
@@ -1814,51 +3537,41 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
       // disable aggregation in the AP
 
       // check if the AP is aggregating
-      if ( GetAP_MaxSizeAmpdu ( apId, staRecordVerboseLevel ) > 0 ) {
+      if ( GetAP_MaxSizeAmpdu ( apId, staSettings.verboseLevel ) > 0 ) {
 
         // I modify the A-MPDU of this AP
-        ModifyAmpdu ( apId, staRecordmaxAmpduSizeWhenAggregationLimited, 1 );
+        ModifyAmpdu ( apId, staSettings.maxAmpduSizeWhenAggregationLimited, 1 );
 
         // Modify the data in the table of APs
-        //for (AP_recordVector::const_iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
-          //if ( (*index)->GetMac () == myaddress ) {
-            Modify_AP_Record ( apId, myaddress, staRecordmaxAmpduSizeWhenAggregationLimited);
-            //std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] AP #" << (*index)->GetApid() << " has MAC: " << (*index)->GetMac() << "" << std::endl;
+        //for (AP_recordVector::iterator index = AP_vector.begin (); index != AP_vector.end (); index++) {
+          //if ( index->GetMac () == myaddress ) {
+            Modify_AP_Record ( apId, myaddress, staSettings.maxAmpduSizeWhenAggregationLimited);
+            //std::cout << Simulator::Now ().GetSeconds() << "\t[GetAnAP_Id] AP #" << index->GetApid() << " has MAC: " << index->GetMac() << "" << std::endl;
         //  }
         //}
 
-        if (staRecordVerboseLevel > 0)
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[SetAssoc] Aggregation in AP #" << apId 
                     << "\twith MAC: " << myaddress 
-                    << "\tset to " << staRecordmaxAmpduSizeWhenAggregationLimited 
+                    << "\tset to " << staSettings.maxAmpduSizeWhenAggregationLimited 
                     << "\t(limited)" << std::endl;
 
         // disable aggregation in all the STAs associated to that AP
-        for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-
-          // I only have to disable aggregation for TCP STAs
-          if ((*index)->Gettypeofapplication () > 2) {
+        // I only have to disable aggregation for TCP STAs, i.e. the ones in the 'bulk' list of the AP
+        STA_recordList& bulkMembers = Get_AP_members (apId).bulk;
+        for (STA_recordList::const_iterator index = bulkMembers.begin (); index != bulkMembers.end (); index++) {
 
-            // if the STA is associated
-            if ((*index)->GetAssoc ()) {
+          ModifyAmpdu ((*index)->GetStaid(), staSettings.maxAmpduSizeWhenAggregationLimited, 1);   // modify the AMPDU in the STA node
+          (*index)->SetMaxSizeAmpdu(staSettings.maxAmpduSizeWhenAggregationLimited);               // update the data in the STA_record structure
 
-              // if the STA is associated to this AP
-              if ((*index)->GetMacOfitsAP() == AP_MAC_address ) {
-
-                ModifyAmpdu ((*index)->GetStaid(), staRecordmaxAmpduSizeWhenAggregationLimited, 1);   // modify the AMPDU in the STA node
-                (*index)->SetMaxSizeAmpdu(staRecordmaxAmpduSizeWhenAggregationLimited);               // update the data in the STA_record structure
-
-                if (staRecordVerboseLevel > 0)
-                  std::cout << Simulator::Now ().GetSeconds() 
-                            << "\t[SetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
-                            << ", associated to AP #" << apId
-                            << "\twith MAC " << (*index)->GetMacOfitsAP() 
-                            << "\tset to " << staRecordmaxAmpduSizeWhenAggregationLimited 
-                            << "\t(limited)" << std::endl;
-              }
-            }
-          }
+          if (LOG_ENABLED (1, staSettings.verboseLevel))
+            std::cout << Simulator::Now ().GetSeconds() 
+                      << "\t[SetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
+                      << ", associated to AP #" << apId
+                      << "\twith MAC " << (*index)->GetMacOfitsAP() 
+                      << "\tset to " << staSettings.maxAmpduSizeWhenAggregationLimited 
+                      << "\t(limited)" << std::endl;
         }
       }
 
@@ -1866,13 +3579,13 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
     } else {
 
       // If the new AP is not aggregating
-      if ( GetAP_MaxSizeAmpdu ( apId, staRecordVerboseLevel ) == 0) {
+      if ( GetAP_MaxSizeAmpdu ( apId, staSettings.verboseLevel ) == 0) {
 
         // Disable aggregation in this STA
-        ModifyAmpdu (staid, staRecordmaxAmpduSizeWhenAggregationLimited, 1);  // modify the AMPDU in the STA node
-        staRecordMaxSizeAmpdu = staRecordmaxAmpduSizeWhenAggregationLimited;        // update the data in the STA_record structure
+        ModifyAmpdu (staid, staSettings.maxAmpduSizeWhenAggregationLimited, 1);  // modify the AMPDU in the STA node
+        staRecordMaxSizeAmpdu = staSettings.maxAmpduSizeWhenAggregationLimited;        // update the data in the STA_record structure
 
-        if (staRecordVerboseLevel > 0)
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[SetAssoc] Aggregation in STA #" << staid 
                     << ", associated to AP #" << apId 
@@ -1880,17 +3593,17 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
                     << "\tset to " << staRecordMaxSizeAmpdu 
                     << "\t(limited)" << std::endl;
 
-  /*    for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+  /*    for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
 
-          if ( (*index)->GetMac () == AP_MAC_address ) {
-              ModifyAmpdu ((*index)->GetStaid(), 0, 1);  // modify the AMPDU in the STA node
-              (*index)->SetMaxSizeAmpdu(0);// update the data in the STA_record structure
+          if ( index->GetMac () == AP_MAC_address ) {
+              ModifyAmpdu (index->GetStaid(), 0, 1);  // modify the AMPDU in the STA node
+              index->SetMaxSizeAmpdu(0);// update the data in the STA_record structure
 
-              if (staRecordVerboseLevel > 0)
+              if (LOG_ENABLED (1, staSettings.verboseLevel))
                 std::cout << Simulator::Now ().GetSeconds() 
-                          << "\t[SetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
+                          << "\t[SetAssoc] Aggregation in STA #" << index->GetStaid() 
                           << ", associated to AP #" << GetAnAP_Id(myaddress) 
-                          << "\twith MAC " << (*index)->GetMac() 
+                          << "\twith MAC " << index->GetMac() 
                           << "\tset to " << 0 
                           << "\t(limited)" << std::endl;
           }
@@ -1900,10 +3613,10 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
      
       } else {
         // Enable aggregation in this STA
-        ModifyAmpdu (staid, staRecordMaxAmpduSize, 1);  // modify the AMPDU in the STA node
-        staRecordMaxSizeAmpdu = staRecordMaxAmpduSize;        // update the data in the STA_record structure
+        ModifyAmpdu (staid, staSettings.maxAmpduSize, 1);  // modify the AMPDU in the STA node
+        staRecordMaxSizeAmpdu = staSettings.maxAmpduSize;        // update the data in the STA_record structure
 
-        if (staRecordVerboseLevel > 0)
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[SetAssoc] Aggregation in STA #" << staid 
                     << ", associated to AP #" << apId 
@@ -1911,16 +3624,16 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
                     << "\tset to " << staRecordMaxSizeAmpdu 
                     << "(enabled)" << std::endl;
   /*      // Enable aggregation in the STA
-          for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-            if ( (*index)->GetMac () == AP_MAC_address ) {
-              ModifyAmpdu ((*index)->GetStaid(), maxAmpduSize, 1);  // modify the AMPDU in the STA node
-              (*index)->SetMaxSizeAmpdu(maxAmpduSize);// update the data in the STA_record structure
+          for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+            if ( index->GetMac () == AP_MAC_address ) {
+              ModifyAmpdu (index->GetStaid(), maxAmpduSize, 1);  // modify the AMPDU in the STA node
+              index->SetMaxSizeAmpdu(maxAmpduSize);// update the data in the STA_record structure
 
-              if (myverbose > 0)
+              if (LOG_ENABLED (1, myverbose))
                 std::cout << Simulator::Now ().GetSeconds() 
-                          << "\t[SetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
+                          << "\t[SetAssoc] Aggregation in STA #" << index->GetStaid() 
                           << ", associated to AP #" << GetAnAP_Id(myaddress) 
-                          << "\twith MAC " << (*index)->GetMac() 
+                          << "\twith MAC " << index->GetMac() 
                           << "\tset to " << maxAmpduSize 
                           << "\t(enabled)" << std::endl;
           }
@@ -1928,9 +3641,9 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
       }
     }
   }
-  if (staRecordVerboseLevel > 0) {
+  if (LOG_ENABLED (1, staSettings.verboseLevel)) {
     List_STA_record ();
-    ListAPs (staRecordVerboseLevel);
+    ListAPs (staSettings.verboseLevel);
   }
 
   if (false) {
@@ -1947,8 +3660,8 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
     for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i) {
         //uint32_t identif;
         //identif = (*i)->GetId();
-        modifyArpParams( (*i), 1.0, staRecordVerboseLevel);
-        Simulator::Schedule (Seconds(5.0), &modifyArpParams, (*i), 50.0, staRecordVerboseLevel);
+        modifyArpParams( (*i), 1.0, staSettings.verboseLevel);
+        Simulator::Schedule (Seconds(5.0), &modifyArpParams, (*i), 50.0, staSettings.verboseLevel);
     }
   }
 }
@@ -1957,49 +3670,52 @@ STA_record::SetAssoc (std::string context, Mac48Address AP_MAC_address)
 void
 STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
 {
+  static uint32_t profilerEntry = callbackProfiler.GetEntry ("UnsetAssoc");
+  ProfileScope profile (profilerEntry);
+
   // 'context' is something like "/NodeList/9/DeviceList/1/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/$ns3::StaWifiMac/Assoc"
 
   // update the data in the STA_record structure
   assoc = false;
   apMac = "00:00:00:00:00:00";
    
-  // auxiliar string
-  std::ostringstream auxString;
-  // create a string with the MAC
-  auxString << "02-06-" << AP_MAC_address;
-  std::string myaddress = auxString.str();
-  NS_ASSERT(!myaddress.empty());
-
   if (VERBOSE_FOR_DEBUG > 0)
     std::cout << Simulator::Now().GetSeconds()
               << "\t[UnsetAssoc] Calling GetAnAP_Id()"
               << std::endl;
 
-  uint32_t apId = GetAnAP_Id(myaddress);
+  uint32_t apId = GetAnAP_Id(AP_MAC_address);
+  TRACE_EVENT (TRACE_DEASSOC, staid, apId, 0);
 
-  uint8_t apChannel = GetAP_WirelessChannel ( apId, staRecordVerboseLevel );
+  // the MAC of the AP, as it is stored in the list of APs
+  std::string myaddress = GetAP_record(apId)->GetMac();
 
-  if (staRecordVerboseLevel > 0) {
+  // update the index of STAs of each AP
+  Remove_AP_member (this);
+
+  uint8_t apChannel = GetAP_WirelessChannel ( apId, staSettings.verboseLevel );
+
+  if (LOG_ENABLED (1, staSettings.verboseLevel)) {
     std::cout << Simulator::Now ().GetSeconds() 
               << "\t[UnsetAssoc] STA #" << staid
               << "\twith AMPDU size " << staRecordMaxSizeAmpdu               
-              << "\trunning application " << typeofapplication 
+              << "\trunning application " << uint16_t (typeofapplication) 
               << "\tde-associated from AP #" << apId
               << " with MAC " << AP_MAC_address 
               << " with channel " << uint16_t (apChannel)
               << "" << std::endl;
     std::cout << "\t\t802.11 version primary interface: "
-              << staRecordversion80211primary
+              << staSettings.version80211primary
               << std::endl;              
   }
 
   // this is the frequency band where the STA can find an AP
   // if it has a single card, only one band can be used
   // if it has two cards, it depends on the band(s) supported by the present AP(s)
-  std::string frequencybandsSupportedBySTA = bandsSupportedBySTA(staRecordNumberWiFiCards, staRecordversion80211primary, staRecordVersion80211Secondary);
+  WifiBand frequencybandsSupportedBySTA = staSettings.bandsSupported;
 
   // This only runs if the aggregation algorithm is running
-  if(staRecordaggregationDisableAlgorithm == 1) {
+  if(staSettings.aggregationDisableAlgorithm == 1) {
 
     // check if there is some VoIP STA already associated to the AP. In this case, I have to enable aggregation:
     // - in the AP
@@ -2007,76 +3723,50 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
     if ( typeofapplication == 1 || typeofapplication == 2 ) {
 
       // check if the AP is not aggregating
-      /*if ( GetAP_MaxSizeAmpdu ( apId, staRecordVerboseLevel ) == 0 ) {
-        if (staRecordVerboseLevel > 0)
+      /*if ( GetAP_MaxSizeAmpdu ( apId, staSettings.verboseLevel ) == 0 ) {
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[UnsetAssoc] This AP is not aggregating" 
                     << std::endl;*/
 
         // check if there is no STA running VoIP associated
-        bool anyStaWithVoIPAssociated = false;
-
-        // Check all the associated STAs, except the one de-associating
-        for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-
-          // Only consider STAs associated to this AP
-          if ( (*index)->GetMacOfitsAP () == AP_MAC_address ) {
-
-            // Only consider VoIP STAs
-            if ( ( (*index)->Gettypeofapplication() == 1 ) || ( (*index)->Gettypeofapplication() == 2 ) ) {
-
-              // It cannot be the one being de-associated
-              if ( (*index)->GetStaid() != staid)
-
-                anyStaWithVoIPAssociated = true;
-            }
-          }
-        }
+        // the one de-associating has already been removed from the lists of the AP
+        bool anyStaWithVoIPAssociated = !Get_AP_members (apId).VoIP.empty ();
 
         // If there is no remaining STA running VoIP associated
         if ( anyStaWithVoIPAssociated == false ) {
           // enable aggregation in the AP
           // Modify the A-MPDU of this AP
-          ModifyAmpdu (apId, staRecordMaxAmpduSize, 1);
-          Modify_AP_Record (apId, myaddress, staRecordMaxAmpduSize);
+          ModifyAmpdu (apId, staSettings.maxAmpduSize, 1);
+          Modify_AP_Record (apId, myaddress, staSettings.maxAmpduSize);
 
-          if (staRecordVerboseLevel > 0)
+          if (LOG_ENABLED (1, staSettings.verboseLevel))
             std::cout << Simulator::Now ().GetSeconds() 
                       << "\t[UnsetAssoc]\tAggregation in AP #" << apId 
                       << "\twith MAC: " << myaddress 
-                      << "\tset to " << staRecordMaxAmpduSize 
+                      << "\tset to " << staSettings.maxAmpduSize 
                       << "\t(enabled)" << std::endl;
 
           // enable aggregation in all the STAs associated to that AP
-          for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-
-            // if the STA is associated
-            if ((*index)->GetAssoc()) {
-
-              // if the STA is associated to this AP
-              if ( (*index)->GetMacOfitsAP() == AP_MAC_address ) {
+          // there is no VoIP STA left, so they are the ones in the 'bulk' list of the AP
+          STA_recordList& bulkMembers = Get_AP_members (apId).bulk;
+          for (STA_recordList::const_iterator index = bulkMembers.begin (); index != bulkMembers.end (); index++) {
 
-                // if the STA is not running VoIP. NOT NEEDED. IF I AM HERE IT MEANS THAT ALL THE STAs ARE TCP
-                //if ((*index)->Gettypeofapplication () > 2) {
+            ModifyAmpdu ((*index)->GetStaid(), staSettings.maxAmpduSize, 1);  // modify the AMPDU in the STA node
+            (*index)->SetMaxSizeAmpdu(staSettings.maxAmpduSize);// update the data in the STA_record structure
 
-                  ModifyAmpdu ((*index)->GetStaid(), staRecordMaxAmpduSize, 1);  // modify the AMPDU in the STA node
-                  (*index)->SetMaxSizeAmpdu(staRecordMaxAmpduSize);// update the data in the STA_record structure
-
-                  if (staRecordVerboseLevel > 0)  
-                    std::cout << Simulator::Now ().GetSeconds() 
-                              << "\t[UnsetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
-                              << "\tassociated to AP #" << apId 
-                              << "\twith MAC " << (*index)->GetMacOfitsAP() 
-                              << "\tset to " << staRecordMaxAmpduSize 
-                              << "\t(enabled)" << std::endl;
-                //}
-              }
-            }
+            if (LOG_ENABLED (1, staSettings.verboseLevel))  
+              std::cout << Simulator::Now ().GetSeconds() 
+                        << "\t[UnsetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
+                        << "\tassociated to AP #" << apId 
+                        << "\twith MAC " << (*index)->GetMacOfitsAP() 
+                        << "\tset to " << staSettings.maxAmpduSize 
+                        << "\t(enabled)" << std::endl;
           }
         }
         else {
           // there is still some VoIP STA associatedm so aggregation cannot be enabled
-          if (staRecordVerboseLevel > 0)
+          if (LOG_ENABLED (1, staSettings.verboseLevel))
             std::cout << Simulator::Now ().GetSeconds() 
                       << "\t[UnsetAssoc] There is still at least a VoIP STA in this AP " << apId 
                       << " so aggregation cannot be enabled" << std::endl;
@@ -2087,13 +3777,13 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
     } else {
 
       // If the AP is not aggregating
-      if ( GetAP_MaxSizeAmpdu ( apId, staRecordVerboseLevel ) == staRecordmaxAmpduSizeWhenAggregationLimited) {
+      if ( GetAP_MaxSizeAmpdu ( apId, staSettings.verboseLevel ) == staSettings.maxAmpduSizeWhenAggregationLimited) {
 
         // Enable aggregation in this STA
-        ModifyAmpdu (staid, staRecordMaxAmpduSize, 1);  // modify the AMPDU in the STA node
-        staRecordMaxSizeAmpdu = staRecordMaxAmpduSize;  // update the data in the STA_record structure
+        ModifyAmpdu (staid, staSettings.maxAmpduSize, 1);  // modify the AMPDU in the STA node
+        staRecordMaxSizeAmpdu = staSettings.maxAmpduSize;  // update the data in the STA_record structure
 
-        if (staRecordVerboseLevel > 0)
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[UnsetAssoc] Aggregation in STA #" << staid 
                     << ", de-associated from AP #" << apId
@@ -2103,22 +3793,22 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
 
       // Enable aggregation in the STA
       /*
-      for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+      for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
 
         // if the STA is associated to this AP
-        if ( (*index)->GetMac() == AP_MAC_address ) {
+        if ( index->GetMac() == AP_MAC_address ) {
 
           // if the STA is not running VoIP
-          if ((*index)->Gettypeofapplication () > 2) {
+          if (index->Gettypeofapplication () > 2) {
 
-            ModifyAmpdu ((*index)->GetStaid(), maxAmpduSize, 1);  // modify the AMPDU in the STA node
-            (*index)->SetMaxSizeAmpdu(maxAmpduSize);// update the data in the STA_record structure
+            ModifyAmpdu (index->GetStaid(), maxAmpduSize, 1);  // modify the AMPDU in the STA node
+            index->SetMaxSizeAmpdu(maxAmpduSize);// update the data in the STA_record structure
 
-            if (staRecordVerboseLevel > 0)
+            if (LOG_ENABLED (1, staSettings.verboseLevel))
               std::cout << Simulator::Now ().GetSeconds() 
-                        << "\t[UnsetAssoc] Aggregation in STA #" << (*index)->GetStaid() 
+                        << "\t[UnsetAssoc] Aggregation in STA #" << index->GetStaid() 
                         << ", de-associated from AP #" << apId
-                        << "\twith MAC " << (*index)->GetMac() 
+                        << "\twith MAC " << index->GetMac() 
                         << "\tset to " << maxAmpduSize 
                         << "\t(enabled)" << std::endl; 
           }
@@ -2126,26 +3816,26 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
       }
     }
   }
-  if (staRecordVerboseLevel > 0) {
+  if (LOG_ENABLED (1, staSettings.verboseLevel)) {
     List_STA_record ();
-    ListAPs (staRecordVerboseLevel);
+    ListAPs (staSettings.verboseLevel);
   }
 
   
   // If wifiModel==1, I don't need to manually change the channel. It will do it automatically
   // If wifiModel==0, I have to manually set the channel of the STA to that of the nearest AP
-  //if (staRecordwifiModel == 0) {  // staRecordwifiModel is the local version of the variable wifiModel
+  //if (staSettings.wifiModel == 0) {  // staSettings.wifiModel is the local version of the variable wifiModel
   
     // wifiModel = 0
     // Put the STA in the channel of the nearest AP
-    if (staRecordnumOperationalChannels > 1) {
+    if (staSettings.numOperationalChannels > 1) {
       // Only for wifiModel = 0. With WifiModel = 1 it is supposed to scan for other APs in other channels 
-      //if (staRecordwifiModel == 0) {
+      //if (staSettings.wifiModel == 0) {
         // Put all the APs in a nodecontainer
         // and get a pointer to the STA
         Ptr<Node> mySTA;
         NodeContainer APs;
-        uint32_t numberAPs = CountAPs (staRecordVerboseLevel);
+        uint32_t numberAPs = CountAPs (staSettings.verboseLevel);
 
         for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i) {
           uint32_t identif;
@@ -2161,18 +3851,18 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
 
         // Find the nearest AP (in order to switch the STA to the channel of the nearest AP)
         Ptr<Node> nearest;
-        nearest = nearestAp (APs, mySTA, staRecordVerboseLevel, frequencybandsSupportedBySTA);
+        nearest = nearestAp (APs, mySTA, staSettings.verboseLevel, frequencybandsSupportedBySTA);
 
         // Move this STA to the channel of the AP identified as the nearest one
         NetDeviceContainer thisDevice;
         thisDevice.Add( (mySTA)->GetDevice(1) ); // this adds the device to the NetDeviceContainer. It has to be device 1, not device 0. I don't know why
      
-        uint8_t newChannel = GetAP_WirelessChannel ( (nearest)->GetId(), staRecordVerboseLevel );
+        uint8_t newChannel = GetAP_WirelessChannel ( (nearest)->GetId(), staSettings.verboseLevel );
 
         if ( HANDOFFMETHOD == 0 )
-          ChangeFrequencyLocal (thisDevice, newChannel, staRecordwifiModel, staRecordVerboseLevel);
+          ChangeFrequencyLocal (thisDevice, newChannel, staSettings.wifiModel, staSettings.verboseLevel);
 
-        if (staRecordVerboseLevel > 0)
+        if (LOG_ENABLED (1, staSettings.verboseLevel))
           std::cout << Simulator::Now ().GetSeconds() 
                     << "\t[UnsetAssoc] STA #" << staid 
                     << " de-associated from AP #" << apId 
@@ -2182,11 +3872,11 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
 
     }
     else { // numOperationalChannels == 1
-      if (staRecordVerboseLevel > 0)
+      if (LOG_ENABLED (1, staSettings.verboseLevel))
         std::cout << Simulator::Now ().GetSeconds() 
                   << "\t[UnsetAssoc] STA #" << staid 
                   << " de-associated from AP #" << apId 
-                  << "\tnot modified because numOperationalChannels=" << staRecordnumOperationalChannels 
+                  << "\tnot modified because numOperationalChannels=" << staSettings.numOperationalChannels 
                   << "\tchannel is still " << uint16_t (apChannel) 
                   << std::endl << std::endl;
     }
@@ -2195,11 +3885,11 @@ STA_record::UnsetAssoc (std::string context, Mac48Address AP_MAC_address)
   /*
   else {
     // wifiModel = 1
-    if (staRecordVerboseLevel > 0)
+    if (LOG_ENABLED (1, staSettings.verboseLevel))
       std::cout << Simulator::Now ().GetSeconds() 
                   << "\t[UnsetAssoc] STA #" << staid 
                   << " de-associated from AP #" << GetAnAP_Id(myaddress) 
-                  << "\tnot modified because wifimodel=" << staRecordwifiModel
+                  << "\tnot modified because wifimodel=" << staSettings.wifiModel
                   << "\tchannel is still " << uint16_t (apChannel) 
                   << std::endl << std::endl;
   }*/
@@ -2218,56 +3908,9 @@ STA_record::SetMaxSizeAmpdu (uint32_t MaxSizeAmpdu)
 }
 
 void
-STA_record::SetVerboseLevel (uint32_t myVerboseLevel)
-{
-  staRecordVerboseLevel = myVerboseLevel;
-}
-
-void
-STA_record::SetnumOperationalChannels (uint32_t mynumOperationalChannels)
-{
-  staRecordnumOperationalChannels = mynumOperationalChannels;
-}
-
-void
-STA_record::SetstaRecordNumberWiFiCards (int mynumWiFiCards) {
-  staRecordNumberWiFiCards = mynumWiFiCards;
-}
-
-void
-STA_record::Setversion80211primary (std::string myversion80211)
-{
-  staRecordversion80211primary = myversion80211;
-}
-
-void
-STA_record::Setversion80211Secondary (std::string myversion80211)
-{
-  staRecordVersion80211Secondary = myversion80211;
-}
-
-void
-STA_record::SetaggregationDisableAlgorithm (uint16_t myaggregationDisableAlgorithm)
-{
-  staRecordaggregationDisableAlgorithm = myaggregationDisableAlgorithm;
-}
-
-void
-STA_record::SetAmpduSize (uint32_t myAmpduSize)
-{
-  staRecordMaxAmpduSize = myAmpduSize;
-}
-
-void
-STA_record::SetmaxAmpduSizeWhenAggregationLimited (uint32_t mymaxAmpduSizeWhenAggregationLimited)
-{
-  staRecordmaxAmpduSizeWhenAggregationLimited = mymaxAmpduSizeWhenAggregationLimited;
-}
-
-void
-STA_record::SetWifiModel (uint32_t mywifiModel)
+STA_record::SetMemberOfAP (uint16_t thisAPid)
 {
-  staRecordwifiModel = mywifiModel;
+  memberOfAP = thisAPid;
 }
 
 bool
@@ -2298,6 +3941,13 @@ STA_record::Gettypeofapplication ()
   return typeofapplication;
 }
 
+uint16_t
+STA_record::GetMemberOfAP ()
+// returns the id of the AP in whose lists the STA is
+{
+  return memberOfAP;
+}
+
 uint32_t
 STA_record::GetMaxSizeAmpdu ()
 // returns the id of the Sta
@@ -2310,8 +3960,8 @@ Get_STA_record_num_AP_app (Mac48Address apMac, uint32_t typeofapplication)
 // counts the number or STAs associated to an AP, with a type of application
 {
   uint32_t AssocNum = 0;
-  for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-    if (((*index)->GetAssoc ()) && ((*index)->GetMacOfitsAP() == apMac) && ( (*index)->Gettypeofapplication()==typeofapplication) ) {
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+    if ((index->GetAssoc ()) && (index->GetMacOfitsAP() == apMac) && ( index->Gettypeofapplication()==typeofapplication) ) {
       AssocNum++;
     }
   }
@@ -2326,15 +3976,15 @@ GetstaRecordMaxSizeAmpdu (uint16_t thisSTAid, uint32_t myverbose)
   uint32_t staRecordMaxSizeAmpdu = 0;
   //std::cout << Simulator::Now ().GetSeconds() << " *** Number of STA associated: " << Get_STA_record_num() << " *****" << std::endl;
 
-  for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-  //std::cout << Simulator::Now ().GetSeconds() << " ********************** AP with ID " << (*index)->GetApid() << " has MAC: " << (*index)->GetMacOfitsAP() << " *****" << std::endl;
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
+  //std::cout << Simulator::Now ().GetSeconds() << " ********************** AP with ID " << index->GetApid() << " has MAC: " << index->GetMacOfitsAP() << " *****" << std::endl;
 
-    if ( (*index)->GetStaid () == thisSTAid ) {
-      staRecordMaxSizeAmpdu = (*index)->GetMaxSizeAmpdu ();
-      if ( myverbose > 0 )
+    if ( index->GetStaid () == thisSTAid ) {
+      staRecordMaxSizeAmpdu = index->GetMaxSizeAmpdu ();
+      if ( LOG_ENABLED (1, myverbose) )
         std::cout << Simulator::Now ().GetSeconds() 
-                  << "\t[GetstaRecordMaxSizeAmpdu]\tAP #" << (*index)->GetMacOfitsAP() 
-                  << " has AMDPU: " << (*index)->GetMaxSizeAmpdu() 
+                  << "\t[GetstaRecordMaxSizeAmpdu]\tAP #" << index->GetMacOfitsAP() 
+                  << " has AMDPU: " << index->GetMaxSizeAmpdu() 
                   << "" << std::endl;
     }
   }
@@ -2342,120 +3992,175 @@ GetstaRecordMaxSizeAmpdu (uint16_t thisSTAid, uint32_t myverbose)
 }
 */
 
-// Save the position of a STA in a file (to be performed periodically)
-static void
-SavePositionSTA (double period, Ptr<Node> node, NodeContainer myApNodes, uint16_t portNumber, std::string fileName)
+// Save the positions of all the STAs in a file (to be performed periodically)
+// A single event per period goes through all the STAs, and all their lines are written to the file at once
+// The record of each STA is found only once, so the AP where it is associated is obtained directly
+class PositionSampler : public PeriodicTask
 {
-  // print the results to a file (they are written at the end of the file)
-  if ( fileName != "" ) {
+  public:
+    PositionSampler (NodeContainer thisApNodes, std::string thisFileName);
+    void AddSTA (Ptr<Node> thisNode, uint16_t thisPortNumber);
+  protected:
+    void Run ();
+    std::string GetName () const { return "SavePositionSTA"; }
+  private:
+    struct sampledSTA {
+      Ptr<Node> node;
+      Ptr<MobilityModel> mobility;
+      uint16_t portNumber;
+      STA_record* record;   // NULL if the STA has no record
+    };
+    void Prepare ();
+    NodeContainer myApNodes;
+    std::string fileName;
+    std::vector<sampledSTA> STAs;
+    bool prepared;
+};
 
-    std::ofstream ofs;
-    ofs.open ( fileName, std::ofstream::out | std::ofstream::app); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
+PositionSampler::PositionSampler (NodeContainer thisApNodes, std::string thisFileName)
+{
+  myApNodes = thisApNodes;
+  fileName = thisFileName;
+  prepared = false;
+}
 
-    // Find the position of the STA
-    Vector posSTA = GetPosition (node);
+// the lines of the STAs are written in the order they are added
+void
+PositionSampler::AddSTA (Ptr<Node> thisNode, uint16_t thisPortNumber)
+{
+  sampledSTA thisSTA;
+  thisSTA.node = thisNode;
+  thisSTA.portNumber = thisPortNumber;
+  thisSTA.record = NULL;
+  STAs.push_back (thisSTA);
+}
 
-    // Find the nearest AP
-    Ptr<Node> myNearestAP;
-    if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now ().GetSeconds()
-                << "\t[SavePositionSTA] Looking for the nearest AP of node "
-                << node->GetId()
-                << std::endl;
+// find the mobility model and the record of each STA. This is done in the first period, because
+// the sampler is created before the records of the STAs
+void
+PositionSampler::Prepare ()
+{
+  std::unordered_map<uint32_t, STA_record*> recordOfSTA;
+  for (STA_recordVector::iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++)
+    recordOfSTA[index->GetStaid ()] = &(*index);
+
+  for (uint32_t i = 0; i < STAs.size (); i++) {
+    STAs[i].mobility = STAs[i].node->GetObject<MobilityModel> ();
+    std::unordered_map<uint32_t, STA_record*>::const_iterator it = recordOfSTA.find (STAs[i].node->GetId ());
+    if (it != recordOfSTA.end ())
+      STAs[i].record = it->second;
+  }
+  prepared = true;
+}
+
+void
+PositionSampler::Run ()
+{
+  if (!prepared)
+    Prepare ();
+  TRACE_EVENT (TRACE_POSITIONS, STAs.size (), 0, 0);
+
+  // the file is kept open until the end (text or columnar)
+  RowWriter* writer = rowSink.Find (fileName);
+
+  double now = Simulator::Now().GetSeconds();
+
+  for (uint32_t i = 0; i < STAs.size (); i++) {
+    Ptr<Node> node = STAs[i].node;
 
-    myNearestAP = nearestAp (myApNodes, node, 0, "both"); // FIXME
+    // Find the position of the STA
+    Vector posSTA = STAs[i].mobility->GetPosition ();
+
+    // Find the nearest AP, using the index of the positions of the APs
+    Ptr<Node> myNearestAP = nearestAp (myApNodes, node, 0, BAND_BOTH); // FIXME
     if (VERBOSE_FOR_DEBUG > 0)
-      std::cout << Simulator::Now ().GetSeconds()
-                << "\t[SavePositionSTA] the nearest AP has id "
-                << myNearestAP->GetId () << std::endl;
+      std::cout << now
+                << "\t[PositionSampler] the nearest AP of node " << node->GetId()
+                << " has id " << myNearestAP->GetId () << std::endl;
 
     Vector posMyNearestAP = GetPosition (myNearestAP);
     double distanceToNearestAP = sqrt ( ( (posSTA.x - posMyNearestAP.x)*(posSTA.x - posMyNearestAP.x) ) + ( (posSTA.y - posMyNearestAP.y)*(posSTA.y - posMyNearestAP.y) ) );
 
-    std::string MACaddressAP;
-
-    // find the AP to which the STA is associated
-    for (STA_recordVector::const_iterator index = assoc_vector.begin (); index != assoc_vector.end (); index++) {
-
-      if ((*index)->GetStaid () == node->GetId()) {
-        // if the STA is associated, find the MAC of the AP
-        if ((*index)->GetAssoc ()) {
-          // auxiliar string
-          std::ostringstream auxString;
-          // create a string with the MAC
-          auxString << "02-06-" << (*index)->GetMacOfitsAP();
-          MACaddressAP = auxString.str();
-          if (VERBOSE_FOR_DEBUG > 0)
-            std::cout << Simulator::Now ().GetSeconds() << "\t[SavePositionSTA] STA with id " << (*index)->GetStaid () << " is associated to the AP with MAC " << MACaddressAP << std::endl;
-        }
-        else {
-          if (VERBOSE_FOR_DEBUG > 0)
-            std::cout << Simulator::Now ().GetSeconds() << "\t[SavePositionSTA] STA with id " << (*index)->GetStaid () << " is not associated to any AP" << std::endl;
-        }
-      }
-    }
-
-    if (!(MACaddressAP.empty())) {
-      // the STA is associated to an AP
+    // the AP to which the STA is associated, if any
+    STA_record* record = STAs[i].record;
+    bool associated = (record != NULL) && record->GetAssoc ();
 
+    if (associated) {
       // Find the position and distance of the AP where this STA is associated
-      Ptr<Node> myAP;
-
-      NS_ASSERT(!(MACaddressAP.empty()));
-      myAP = myApNodes.Get (GetAnAP_Id(MACaddressAP));
-
-      Vector posMyAP = GetPosition (myAP);
+      uint16_t myAPid = GetAnAP_Id (record->GetMacOfitsAP());
+      Vector posMyAP = GetPosition (myApNodes.Get (myAPid));
       double distanceToMyAP = sqrt ( ( (posSTA.x - posMyAP.x)*(posSTA.x - posMyAP.x) ) + ( (posSTA.y - posMyAP.y)*(posSTA.y - posMyAP.y) ) );
 
       // print a line in the output file
-      ofs << Simulator::Now().GetSeconds() << "\t"
-          << (node)->GetId() << "\t"
-          << portNumber << "\t"
-          << posSTA.x << "\t"
-          << posSTA.y << "\t"
-          << (myNearestAP)->GetId() << "\t"
-          << posMyNearestAP.x << "\t"
-          << posMyNearestAP.y << "\t"
-          << distanceToNearestAP << "\t"
-          << GetAnAP_Id(MACaddressAP) << "\t"
-          << posMyAP.x << "\t"
-          << posMyAP.y << "\t"
-          << distanceToMyAP << "\t"
-          << std::endl;
+      writer->Double (now)
+             .Uint (node->GetId())
+             .Uint (STAs[i].portNumber)
+             .Double (posSTA.x)
+             .Double (posSTA.y)
+             .Uint (myNearestAP->GetId())
+             .Double (posMyNearestAP.x)
+             .Double (posMyNearestAP.y)
+             .Double (distanceToNearestAP)
+             .Uint (myAPid)
+             .Double (posMyAP.x)
+             .Double (posMyAP.y)
+             .Double (distanceToMyAP)
+             .EndRow ();
     }
     else {
       // the STA is NOT associated to any AP
       // print a line in the output file
-      ofs << Simulator::Now().GetSeconds() << "\t"
-          << (node)->GetId() << "\t"
-          << portNumber << "\t"
-          << posSTA.x << "\t"
-          << posSTA.y << "\t"
-          << (myNearestAP)->GetId() << "\t"
-          << posMyNearestAP.x << "\t"
-          << posMyNearestAP.y << "\t"
-          << distanceToNearestAP << "\t"
-          << "" << "\t"   // as it is not associated, leave this blank
-          << "" << "\t"   // as it is not associated, leave this blank
-          << "" << "\t"   // as it is not associated, leave this blank
-          << "" << "\t"   // as it is not associated, leave this blank
-          << std::endl;
+      writer->Double (now)
+             .Uint (node->GetId())
+             .Uint (STAs[i].portNumber)
+             .Double (posSTA.x)
+             .Double (posSTA.y)
+             .Uint (myNearestAP->GetId())
+             .Double (posMyNearestAP.x)
+             .Double (posMyNearestAP.y)
+             .Double (distanceToNearestAP)
+             .Null ()   // as it is not associated, leave this blank
+             .Null ()
+             .Null ()
+             .Null ()
+             .EndRow ();
     }
-    
-    // re-schedule
-    Simulator::Schedule (Seconds (period), &SavePositionSTA, period, node, myApNodes, portNumber, fileName);
   }
 }
 
 
 // Print the position of a node
 // taken from https://www.nsnam.org/doxygen/wifi-ap_8cc.html
-static void
-ReportPosition (double period, Ptr<Node> node, int i, int type, int myverbose, NodeContainer myApNodes)
+class ReportPositionTask : public PeriodicTask
+{
+  public:
+    ReportPositionTask (Ptr<Node> thisNode, int thisI, int thisType, int thisVerbose, NodeContainer thisApNodes);
+  protected:
+    void Run ();
+    std::string GetName () const { return "ReportPosition"; }
+  private:
+    Ptr<Node> node;
+    int i;
+    int type;
+    int myverbose;
+    NodeContainer myApNodes;
+};
+
+ReportPositionTask::ReportPositionTask (Ptr<Node> thisNode, int thisI, int thisType, int thisVerbose, NodeContainer thisApNodes)
+{
+  node = thisNode;
+  i = thisI;
+  type = thisType;
+  myverbose = thisVerbose;
+  myApNodes = thisApNodes;
+}
+
+void
+ReportPositionTask::Run ()
 {
   Vector posSTA = GetPosition (node);
 
-  if (myverbose > 2) {
+  if (LOG_ENABLED (3, myverbose)) {
     // type = 0 means it will write the position of an AP
     if (type == 0) {
       std::cout << Simulator::Now().GetSeconds()
@@ -2468,7 +4173,7 @@ ReportPosition (double period, Ptr<Node> node, int i, int type, int myverbose, N
     else {
       // Find the nearest AP
       Ptr<Node> myNearestAP;
-      myNearestAP = nearestAp (myApNodes, node, myverbose, "both"); // FIXME
+      myNearestAP = nearestAp (myApNodes, node, myverbose, BAND_BOTH); // FIXME
       Vector posMyNearestAP = GetPosition (myNearestAP);
       double distance = sqrt ( ( (posSTA.x - posMyNearestAP.x)*(posSTA.x - posMyNearestAP.x) ) + ( (posSTA.y - posMyNearestAP.y)*(posSTA.y - posMyNearestAP.y) ) );
 
@@ -2481,45 +4186,103 @@ ReportPosition (double period, Ptr<Node> node, int i, int type, int myverbose, N
                 << std::endl;
     }
   }
-
-  // re-schedule
-  Simulator::Schedule (Seconds (period), &ReportPosition, period, node, i, type, myverbose, myApNodes);
 }
 
 
 
 /********* FUNCTIONS ************/
-FlowMonitorHelper flowmon;  // FIXME avoid this global variable
-
-
-// Struct for storing the statistics of the VoIP flows
-struct FlowStatistics {
-  double acumDelay;
-  double acumJitter;
-  uint32_t acumRxPackets;
-  uint32_t acumLostPackets;
-  uint32_t acumRxBytes;
-  double lastIntervalDelay;
-  double lastIntervalJitter;
-  uint32_t lastIntervalRxPackets;
-  uint32_t lastIntervalLostPackets;
-  uint32_t lastIntervalRxBytes;
-  uint16_t destinationPort;
-};
+FlowMonitorHelper* flowmon;  // FIXME avoid this global variable. A new one is created in each replication
 
-struct AllTheFlowStatistics {
-  uint32_t numberVoIPUploadFlows;
-  uint32_t numberVoIPDownloadFlows;
-  uint32_t numberTCPUploadFlows;
-  uint32_t numberTCPDownloadFlows;
-  uint32_t numberVideoDownloadFlows;
-  FlowStatistics* FlowStatisticsVoIPUpload;
-  FlowStatistics* FlowStatisticsVoIPDownload;
-  FlowStatistics* FlowStatisticsTCPUpload;
-  FlowStatistics* FlowStatisticsTCPDownload;
-  FlowStatistics* FlowStatisticsVideoDownload;
+
+// Table of the flows, for storing their statistics during the simulation. There is an entry per application,
+// and its flow id is assigned when the application is installed, i.e. the order is VoIP upload, VoIP download,
+// TCP upload, TCP download and video download, the same one of the STAs and of the output files
+// TCP applications generate 2 flows: 1 for data and 1 for ACKs. Only the one of data is in the table
+// Each field is an array indexed by the flow id, so the loops that go through the flows use contiguous memory
+class FlowTable
+{
+  public:
+    void Clear ();
+    uint32_t AddFlow (uint8_t typeOfFlow, uint16_t thisDestinationPort, uint32_t thisNodeId);
+    uint32_t GetNumberFlows ();
+    int32_t GetFlowOfPort (uint16_t thisDestinationPort);  // -1 if the port does not belong to any flow
+    int32_t GetFlowOfNode (uint32_t thisNodeId);           // -1 if the node does not run any application
+
+    std::vector<uint8_t> type;        // 1 VoIP upload, 2 VoIP download, 3 TCP upload, 4 TCP download, 5 video download
+    std::vector<uint16_t> destinationPort;
+    std::vector<uint32_t> nodeId;     // the STA where the application runs
+    std::vector<double> acumDelay;
+    std::vector<double> acumJitter;
+    std::vector<uint32_t> acumRxPackets;
+    std::vector<uint32_t> acumLostPackets;
+    std::vector<uint32_t> acumRxBytes;
+    std::vector<double> lastIntervalDelay;    // NaN if no packet has been received in the interval
+    std::vector<double> lastIntervalJitter;
+    std::vector<uint32_t> lastIntervalRxPackets;
+    std::vector<uint32_t> lastIntervalLostPackets;
+    std::vector<uint32_t> lastIntervalRxBytes;
+  private:
+    std::map<uint16_t, uint32_t> flowOfPort;
+    std::vector<int32_t> flowOfNode;  // indexed by the id of the node
 };
 
+void
+FlowTable::Clear ()
+{
+  *this = FlowTable ();
+}
+
+// add the flow of an application that has just been installed. It returns the id of the flow
+uint32_t
+FlowTable::AddFlow (uint8_t typeOfFlow, uint16_t thisDestinationPort, uint32_t thisNodeId)
+{
+  uint32_t flow = type.size ();
+  type.push_back (typeOfFlow);
+  destinationPort.push_back (thisDestinationPort);
+  nodeId.push_back (thisNodeId);
+  acumDelay.push_back (0.0);
+  acumJitter.push_back (0.0);
+  acumRxPackets.push_back (0);
+  acumLostPackets.push_back (0);
+  acumRxBytes.push_back (0);
+  lastIntervalDelay.push_back (std::numeric_limits<double>::quiet_NaN ());
+  lastIntervalJitter.push_back (std::numeric_limits<double>::quiet_NaN ());
+  lastIntervalRxPackets.push_back (0);
+  lastIntervalLostPackets.push_back (0);
+  lastIntervalRxBytes.push_back (0);
+
+  flowOfPort[thisDestinationPort] = flow;
+  if (thisNodeId >= flowOfNode.size ())
+    flowOfNode.resize (thisNodeId + 1, -1);
+  flowOfNode[thisNodeId] = flow;
+  return flow;
+}
+
+uint32_t
+FlowTable::GetNumberFlows ()
+{
+  return type.size ();
+}
+
+int32_t
+FlowTable::GetFlowOfPort (uint16_t thisDestinationPort)
+{
+  std::map<uint16_t, uint32_t>::const_iterator it = flowOfPort.find (thisDestinationPort);
+  if (it == flowOfPort.end ())
+    return -1;
+  return it->second;
+}
+
+int32_t
+FlowTable::GetFlowOfNode (uint32_t thisNodeId)
+{
+  if (thisNodeId >= flowOfNode.size ())
+    return -1;
+  return flowOfNode[thisNodeId];
+}
+
+FlowTable flowTable;  // filled when the applications are installed
+
 
 // The number of parameters for calling functions using 'schedule' is limited to 6, so I have to create a struct
 struct adjustAmpduParameters {
@@ -2530,239 +4293,38 @@ struct adjustAmpduParameters {
   std::string mynameAMPDUFile;
   uint16_t methodAdjustAmpdu;
   uint32_t stepAdjustAmpdu; 
+  double ampduGrowthFactor;
+  double ampduShrinkFactor;
 };
 
 
-// Dynamically adjust the size of the AMPDU
-void adjustAMPDU (//FlowStatistics* myFlowStatistics,
-                  AllTheFlowStatistics myAllTheFlowStatistics,
-                  adjustAmpduParameters myparam,
-                  uint32_t* belowLatencyAmpduValue,
-                  uint32_t* aboveLatencyAmpduValue,
-                  uint32_t myNumberAPs)  
-{
-  // For each AP, find the highest value of the delay of the associated STAs
-  for (AP_recordVector::const_iterator indexAP = AP_vector.begin (); indexAP != AP_vector.end (); indexAP++) {
-    if (myparam.verboseLevel > 0)
-      std::cout << Simulator::Now ().GetSeconds()
-                << "\t[adjustAMPDU]"
-                << "\tAP #" << (*indexAP)->GetApid() 
-                << " with MAC " << (*indexAP)->GetMac() 
-                << " Max size AMPDU " << (*indexAP)->GetMaxSizeAmpdu() 
-                << " Channel " << uint16_t((*indexAP)->GetWirelessChannel())
-                << std::endl;
-
-    // find the highest latency of all the VoIP STAs associated to that AP
-    double highestLatencyVoIPFlows = 0.0;
-
-    for (STA_recordVector::const_iterator indexSTA = assoc_vector.begin (); indexSTA != assoc_vector.end (); indexSTA++) {
-
-      // check if the STA is associated to an AP
-      if ((*indexSTA)->GetAssoc()) {
-        // auxiliar string
-        std::ostringstream auxString;
-        // create a string with the MAC
-        auxString << "02-06-" << (*indexSTA)->GetMacOfitsAP();
-        std::string addressOfTheAPwhereThisSTAis = auxString.str();
-        NS_ASSERT(!addressOfTheAPwhereThisSTAis.empty());
-
-        // check if the STA is associated to this AP
-        if ( (*indexAP)->GetMac() == addressOfTheAPwhereThisSTAis ) {
-
-          if (myparam.verboseLevel > 0) 
-            std::cout << Simulator::Now ().GetSeconds() 
-                      << "\t[adjustAMPDU]"
-                      << "\t\tSTA #" << (*indexSTA)->GetStaid() 
-                      << "\tassociated to AP #" << GetAnAP_Id(addressOfTheAPwhereThisSTAis) 
-                      << "\twith MAC " << (*indexSTA)->GetMacOfitsAP();
-
-          // VoIP upload
-          if ((*indexSTA)->Gettypeofapplication () == 1) {
-            if (myparam.verboseLevel > 0)
-              std::cout << "\tVoIP upload";
-
-            // index for the vector of statistics of VoIPDownload flows
-            uint32_t indexForVector = (*indexSTA)->GetStaid()
-                                      - AP_vector.size();
-
-            // 'std::isnan' checks if the value is not a number
-            if (!std::isnan(myAllTheFlowStatistics.FlowStatisticsVoIPUpload[indexForVector].lastIntervalDelay)) {
-              if (myparam.verboseLevel > 0)
-                std::cout << "\tDelay: " << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[indexForVector].lastIntervalDelay 
-                          << "\tThroughput: " << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[indexForVector].lastIntervalRxBytes * 8 / myparam.timeInterval
-                          //<< "\t indexForVector is " << indexForVector
-                          ;
-
-              // if the latency of this STA is the highest one so far, update the value of the highest latency
-              if (  myAllTheFlowStatistics.FlowStatisticsVoIPUpload[ indexForVector ].lastIntervalDelay > highestLatencyVoIPFlows && 
-                    !std::isnan(myAllTheFlowStatistics.FlowStatisticsVoIPUpload[ indexForVector].lastIntervalDelay))
-
-                highestLatencyVoIPFlows = myAllTheFlowStatistics.FlowStatisticsVoIPUpload[ indexForVector].lastIntervalDelay;
-
-            } else {
-              if (myparam.verboseLevel > 0) 
-                std::cout << "\tDelay not defined in this period" 
-                          //<< "\t (*indexSTA)->GetStaid()  - AP_vector.size() is " << (*indexSTA)->GetStaid() - AP_vector.size()
-                          ;
-            }
-
-
-          // VoIP download
-          } else if ((*indexSTA)->Gettypeofapplication () == 2) {
-            if (myparam.verboseLevel > 0)
-              std::cout << "\tVoIP download";
-
-            // index for the vector of statistics of VoIPDownload flows
-            uint32_t indexForVector = (*indexSTA)->GetStaid()
-                                      - AP_vector.size()
-                                      - myAllTheFlowStatistics.numberVoIPUploadFlows;
-
-            // 'std::isnan' checks if the value is not a number                                      
-            if (!std::isnan(myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector].lastIntervalDelay)) {
-              if (myparam.verboseLevel > 0)
-                std::cout << "\tDelay: " << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector ].lastIntervalDelay 
-                          << "\tThroughput: " << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector ].lastIntervalRxBytes * 8 / myparam.timeInterval
-                          //<< "\t indexForVector is " << indexForVector
-                          ;
-
-              // if the latency of this STA is the highest one so far, update the value of the highest latency
-              if (  myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector ].lastIntervalDelay > highestLatencyVoIPFlows && 
-                    !std::isnan(myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector ].lastIntervalDelay))
-
-                highestLatencyVoIPFlows = myAllTheFlowStatistics.FlowStatisticsVoIPDownload[ indexForVector ].lastIntervalDelay;
-
-            } else {
-              if (myparam.verboseLevel > 0) 
-                std::cout << "\tDelay not defined in this period" 
-                          //<< "\t indexForVector is " << indexForVector
-                          ;
-            }
-
-
-          // TCP upload
-          } else if ((*indexSTA)->Gettypeofapplication () == 3) {
-            if (myparam.verboseLevel > 0)
-              std::cout << "\tTCP upload";
-
-            // index for the vector of statistics of TCPload flows
-            uint16_t indexForVector = (*indexSTA)->GetStaid()
-                                      - AP_vector.size()
-                                      - myAllTheFlowStatistics.numberVoIPDownloadFlows
-                                      - myAllTheFlowStatistics.numberTCPUploadFlows;
-
-            // 'std::isnan' checks if the value is not a number
-            if (!std::isnan(myAllTheFlowStatistics.FlowStatisticsTCPUpload[ indexForVector ].lastIntervalRxBytes)) {
-              if (myparam.verboseLevel > 0)
-              std::cout << "\t\t\t"
-                        << "\tThroughput: " << myAllTheFlowStatistics.FlowStatisticsTCPUpload[ indexForVector ].lastIntervalRxBytes * 8 / myparam.timeInterval 
-                        //<< "\t indexForVector is " << indexForVector
-                        ;
-
-            } else {
-              if (myparam.verboseLevel > 0)
-                std::cout << "\tThroughput not defined in this period" 
-                          //<< "\t (*indexSTA)->GetStaid()  - AP_vector.size() is " << (*indexSTA)->GetStaid() - AP_vector.size()
-                          ;
-            }
-
-
-          // TCP download
-          } else if ((*indexSTA)->Gettypeofapplication () == 4) {
-            if (myparam.verboseLevel > 0)
-              std::cout << "\tTCP download";
-
-            // index for the vector of statistics of TCPDownload flows
-            uint32_t indexForVector = (*indexSTA)->GetStaid()
-                                      - AP_vector.size()
-                                      - myAllTheFlowStatistics.numberVoIPUploadFlows
-                                      - myAllTheFlowStatistics.numberVoIPDownloadFlows
-                                      - myAllTheFlowStatistics.numberTCPUploadFlows;
-
-            // 'std::isnan' checks if the value is not a number
-            if (!std::isnan(myAllTheFlowStatistics.FlowStatisticsTCPDownload[ indexForVector ].lastIntervalRxBytes)) {
-              if (myparam.verboseLevel > 0)
-              std::cout << "\t\t\t"
-                        << "\tThroughput: " << myAllTheFlowStatistics.FlowStatisticsTCPDownload[ indexForVector ].lastIntervalRxBytes * 8 / myparam.timeInterval 
-                        //<< "\t indexForVector is " << indexForVector
-                        ;
-
-            } else {
-              if (myparam.verboseLevel > 0)
-                std::cout << "\tThroughput not defined in this period" 
-                          //<< "\t indexForVector is " << indexForVector
-                          ;
-            }
-
-
-          // Video download
-          } else if ((*indexSTA)->Gettypeofapplication () == 5) {
-            if (myparam.verboseLevel > 0)
-              std::cout << "\tVideo download";
-
-            // index for the vector of statistics of VideoDownload flows
-            uint32_t indexForVector = (*indexSTA)->GetStaid()
-                                      - AP_vector.size()
-                                      - myAllTheFlowStatistics.numberVoIPUploadFlows
-                                      - myAllTheFlowStatistics.numberVoIPDownloadFlows
-                                      - myAllTheFlowStatistics.numberTCPUploadFlows
-                                      - myAllTheFlowStatistics.numberTCPDownloadFlows;
-
-            // 'std::isnan' checks if the value is not a number
-            if (!std::isnan(myAllTheFlowStatistics.FlowStatisticsVideoDownload[ indexForVector ].lastIntervalRxBytes)) {
-              if (myparam.verboseLevel > 0)
-              std::cout << "\t\t"
-                        << "\tThroughput: " << myAllTheFlowStatistics.FlowStatisticsVideoDownload[ indexForVector ].lastIntervalRxBytes * 8 / myparam.timeInterval 
-                        //<< "\t indexForVector is " << indexForVector
-                        ;
-            } else {
-              if (myparam.verboseLevel > 0)
-                std::cout << "\tThroughput not defined in this period" 
-                          //<< "\t indexForVector is " << indexForVector
-                          ;
-            }
-          }
-          if (myparam.verboseLevel > 0)           
-            std::cout << "\n";
-        }
-
-      // this STA is not associated to any AP
-      } else {
-        if (myparam.verboseLevel > 0)
-          std::cout << Simulator::Now ().GetSeconds() 
-                    << "\t[adjustAMPDU]"
-                    << "\t\tSTA #" << (*indexSTA)->GetStaid() 
-                    << "\tnot associated to any AP #";
-      }
-    }
-
-
-    // Adjust the value of the AMPDU
-
-    // Variable to store the new value of the max AMPDU
-    uint32_t newAmpduValue;
-    
-    // Variable to store the current value of the max AMPDU
-    uint32_t currentAmpduValue = (*indexAP)->GetMaxSizeAmpdu();
+// Controllers of the AMPDU size. Each one implements a value of 'methodAdjustAmpdu'
+// 'NewAmpduValue' is called once per AP and per interval, with the highest latency of the VoIP flows of the AP
 
-    // Variable to store the minimum AMPDU value
-    uint32_t minimumAmpduValue = MTU + 100;
+// First method to adjust AMPDU: linear increase and linear decrease
+class AmpduControllerLinear
+{
+  public:
+    AmpduControllerLinear (const adjustAmpduParameters& myparam)
+      : latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize), stepAdjustAmpdu (myparam.stepAdjustAmpdu) {}
 
-    // First method to adjust AMPDU: linear increase and linear decrease
-    if ( myparam.methodAdjustAmpdu == 0 ) {
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
+      uint32_t newAmpduValue;
 
       // if the latency is above the latency budget, we decrease the AMPDU value
-      if ( highestLatencyVoIPFlows > myparam.latencyBudget ) {
+      if ( highestLatencyVoIPFlows > latencyBudget ) {
 
         // linearly decrease the AMPDU value
 
         // check if the current value is smaller than the step
-        if (currentAmpduValue < ( AGGRESSIVENESS * myparam.stepAdjustAmpdu ) ) {
+        if (currentAmpduValue < ( AGGRESSIVENESS * stepAdjustAmpdu ) ) {
           // I can only decrease to the minimum
           newAmpduValue = minimumAmpduValue;
 
         } else {
           // decrease a step
-          newAmpduValue = currentAmpduValue - ( AGGRESSIVENESS * myparam.stepAdjustAmpdu );
+          newAmpduValue = currentAmpduValue - ( AGGRESSIVENESS * stepAdjustAmpdu );
 
           // make sure that the value is at least the minimum
           if ( newAmpduValue < minimumAmpduValue )
@@ -2772,458 +4334,746 @@ void adjustAMPDU (//FlowStatistics* myFlowStatistics,
       // if the latency is below the latency budget, we increase the AMPDU value
       } else {
         // increase the AMPDU value
-        newAmpduValue = std::min(( currentAmpduValue + myparam.stepAdjustAmpdu ), myparam.maxAmpduSize); // avoid values above the maximum
+        newAmpduValue = std::min(( currentAmpduValue + stepAdjustAmpdu ), maxAmpduSize); // avoid values above the maximum
       }
+      return newAmpduValue;
     }
 
-    // Second method to adjust AMPDU: linear increase (double aggressiveness, i.e. factor of 2), drastic decrease (instantaneous reduction to the minimum),  
-    else if ( myparam.methodAdjustAmpdu == 1 ) {
+  private:
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+    uint32_t stepAdjustAmpdu;
+};
+
+// Second method to adjust AMPDU: linear increase (double aggressiveness, i.e. factor of 2), drastic decrease (instantaneous reduction to the minimum),  
+class AmpduControllerDrasticReset
+{
+  public:
+    AmpduControllerDrasticReset (const adjustAmpduParameters& myparam)
+      : latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize), stepAdjustAmpdu (myparam.stepAdjustAmpdu) {}
 
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
       //  if the latency is above the latency budget
-      if ( highestLatencyVoIPFlows > myparam.latencyBudget ) {
+      if ( highestLatencyVoIPFlows > latencyBudget ) {
         // decrease the AMPDU value
-        newAmpduValue = minimumAmpduValue;
+        return minimumAmpduValue;
 
       // if the latency is below the latency budget  
       } else {
         // increase the AMPDU value
-        newAmpduValue = std::min(( currentAmpduValue + ( 2 * myparam.stepAdjustAmpdu) ), myparam.maxAmpduSize); // avoid values above the maximum
+        return std::min(( currentAmpduValue + ( 2 * stepAdjustAmpdu) ), maxAmpduSize); // avoid values above the maximum
       }
     }
 
-    // Third method to adjust AMPDU: half of what is left 
-    else if ( myparam.methodAdjustAmpdu == 2 ) {
+  private:
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+    uint32_t stepAdjustAmpdu;
+};
+
+// Third method to adjust AMPDU: half of what is left 
+class AmpduControllerGeometric
+{
+  public:
+    AmpduControllerGeometric (const adjustAmpduParameters& myparam)
+      : latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize) {}
 
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
       //  if the latency is above the latency budget
-      if ( highestLatencyVoIPFlows > myparam.latencyBudget ) {
+      if ( highestLatencyVoIPFlows > latencyBudget ) {
         // decrease the AMPDU value
-        newAmpduValue = std::floor((currentAmpduValue - minimumAmpduValue) / 2);
+        return std::floor((currentAmpduValue - minimumAmpduValue) / 2);
 
       // if the latency is below the latency budget  
       } else {
         // increase the AMPDU value
-        newAmpduValue = currentAmpduValue + std::ceil(( myparam.maxAmpduSize - currentAmpduValue + 1 ) / 2);
+        return currentAmpduValue + std::ceil(( maxAmpduSize - currentAmpduValue + 1 ) / 2);
       }
     }
 
-    // Fourth method to adjust AMPDU: geometric increase (x2) and geometric decrease (x0.618)
-    else if ( myparam.methodAdjustAmpdu == 3 ) {
+  private:
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+};
+
+// Fourth method to adjust AMPDU: geometric increase (x2) and geometric decrease (x0.618)
+// The factors can be changed with 'ampduGrowthFactor' and 'ampduShrinkFactor'
+class AmpduControllerGoldenRatio
+{
+  public:
+    AmpduControllerGoldenRatio (const adjustAmpduParameters& myparam)
+      : latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize),
+        ampduGrowthFactor (myparam.ampduGrowthFactor), ampduShrinkFactor (myparam.ampduShrinkFactor) {}
 
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
       //  if the latency is below the latency budget
-      if ( highestLatencyVoIPFlows < myparam.latencyBudget ) {
+      if ( highestLatencyVoIPFlows < latencyBudget ) {
         // increase the AMPDU value
-        newAmpduValue = std::min(uint32_t( currentAmpduValue * 2), myparam.maxAmpduSize);
+        return std::min(uint32_t( currentAmpduValue * ampduGrowthFactor), maxAmpduSize);
 
       // if the latency is above the latency budget  
       } else {
         // decrease the AMPDU value
-        newAmpduValue = std::max(uint32_t( currentAmpduValue * 0.618 ), minimumAmpduValue); // avoid values above the maximum
+        return std::max(uint32_t( currentAmpduValue * ampduShrinkFactor ), minimumAmpduValue); // avoid values above the maximum
       }
     }
 
-    // Fifth method for adjusting the AMPDU
-    else if ( myparam.methodAdjustAmpdu == 4 ) {
+  private:
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+    double ampduGrowthFactor;
+    double ampduShrinkFactor;
+};
+
+// Fifth method for adjusting the AMPDU: bisection between the last value below the latency budget and the last one above it
+// As before, there is a single pair of values, shared by all the APs
+class AmpduControllerBisection
+{
+  public:
+    AmpduControllerBisection (const adjustAmpduParameters& myparam)
+      : verboseLevel (myparam.verboseLevel), latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize), stepAdjustAmpdu (myparam.stepAdjustAmpdu),
+        belowLatencyAmpduValue (MTU + 100), aboveLatencyAmpduValue (myparam.maxAmpduSize) {}
+
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
+      uint32_t newAmpduValue;
 
       //  if the latency is above the latency budget
-      if ( highestLatencyVoIPFlows > myparam.latencyBudget ) {
-        if (myparam.verboseLevel > 2)
+      if ( highestLatencyVoIPFlows > latencyBudget ) {
+        if (LOG_ENABLED (3, verboseLevel))
           std::cout << "[adjustAMPDU] above latency\n";
 
-        *aboveLatencyAmpduValue = std::max( currentAmpduValue - myparam.stepAdjustAmpdu, minimumAmpduValue);
-        *belowLatencyAmpduValue = std::max( *belowLatencyAmpduValue - myparam.stepAdjustAmpdu, minimumAmpduValue);
-        newAmpduValue = std::ceil((*aboveLatencyAmpduValue + *belowLatencyAmpduValue + 1 ) / 2);
-        if ( newAmpduValue > myparam.maxAmpduSize ) 
-          newAmpduValue = myparam.maxAmpduSize;
+        aboveLatencyAmpduValue = std::max( currentAmpduValue - stepAdjustAmpdu, minimumAmpduValue);
+        belowLatencyAmpduValue = std::max( belowLatencyAmpduValue - stepAdjustAmpdu, minimumAmpduValue);
+        newAmpduValue = std::ceil((aboveLatencyAmpduValue + belowLatencyAmpduValue + 1 ) / 2);
+        if ( newAmpduValue > maxAmpduSize ) 
+          newAmpduValue = maxAmpduSize;
         if ( newAmpduValue < minimumAmpduValue ) 
           newAmpduValue = minimumAmpduValue;
 
-      } else if (std::abs( myparam.latencyBudget - highestLatencyVoIPFlows ) > 0.001 ) {      
+      } else if (std::abs( latencyBudget - highestLatencyVoIPFlows ) > 0.001 ) {      
         // if the latency is not very close to the latency budget (epsilon = 0.001 s)
-        if (myparam.verboseLevel > 2)
+        if (LOG_ENABLED (3, verboseLevel))
           std::cout << "[adjustAMPDU] not very close to the limit\n";
 
-        *belowLatencyAmpduValue = std::min( currentAmpduValue + myparam.stepAdjustAmpdu, myparam.maxAmpduSize); // avoid values above the maximum
-        *aboveLatencyAmpduValue = std::min( *aboveLatencyAmpduValue + myparam.stepAdjustAmpdu, myparam.maxAmpduSize); // avoid values above the maximum
+        belowLatencyAmpduValue = std::min( currentAmpduValue + stepAdjustAmpdu, maxAmpduSize); // avoid values above the maximum
+        aboveLatencyAmpduValue = std::min( aboveLatencyAmpduValue + stepAdjustAmpdu, maxAmpduSize); // avoid values above the maximum
 
-        newAmpduValue = std::ceil((*aboveLatencyAmpduValue + *belowLatencyAmpduValue + 1 ) / 2);
-        if ( newAmpduValue > myparam.maxAmpduSize ) 
-          newAmpduValue = myparam.maxAmpduSize;
+        newAmpduValue = std::ceil((aboveLatencyAmpduValue + belowLatencyAmpduValue + 1 ) / 2);
+        if ( newAmpduValue > maxAmpduSize ) 
+          newAmpduValue = maxAmpduSize;
         if ( newAmpduValue < minimumAmpduValue ) 
           newAmpduValue = minimumAmpduValue;
 
-      } else {
-        // do nothing
-        if (myparam.verboseLevel > 2)
-          std::cout << "[adjustAMPDU] very close to the limit\n";
-        newAmpduValue = currentAmpduValue;
-      }
+      } else {
+        // do nothing
+        if (LOG_ENABLED (3, verboseLevel))
+          std::cout << "[adjustAMPDU] very close to the limit\n";
+        newAmpduValue = currentAmpduValue;
+      }
+
+      if (LOG_ENABLED (3, verboseLevel)) {
+        std::cout << Simulator::Now ().GetSeconds()  << '\t';
+        std::cout << "[adjustAMPDU] latencyBudget: " << latencyBudget << '\t';
+        std::cout << "highest latency: " << highestLatencyVoIPFlows << '\t';
+        std::cout << "currentAmpduValue: " << currentAmpduValue << '\t';
+        std::cout << "belowLatencyAmpduValue: " << belowLatencyAmpduValue << '\t';
+        std::cout << "aboveLatencyAmpduValue: " << aboveLatencyAmpduValue << '\t';
+        std::cout << "newAmpduValue: " << newAmpduValue << '\n';
+      }
+      return newAmpduValue;
+    }
+
+  private:
+    uint32_t verboseLevel;
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+    uint32_t stepAdjustAmpdu;
+    uint32_t belowLatencyAmpduValue;  // last AMPDU value for which latency was below the limit
+    uint32_t aboveLatencyAmpduValue;  // last AMPDU value for which latency was above the limit
+};
+
+// Sixth method for adjusting the AMPDU: drastic increase (instantaneous increase to the maximum) and linear decrease (double aggressiveness, i.e. factor of 2)
+class AmpduControllerJumpToMax
+{
+  public:
+    AmpduControllerJumpToMax (const adjustAmpduParameters& myparam)
+      : latencyBudget (myparam.latencyBudget), maxAmpduSize (myparam.maxAmpduSize), stepAdjustAmpdu (myparam.stepAdjustAmpdu) {}
+
+    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+    {
+      uint32_t newAmpduValue;
+
+      //  if the latency is above the latency budget
+      if ( highestLatencyVoIPFlows > latencyBudget ) {
+        // linearly decrease the AMPDU value
+
+        // check if the current value is smaller than the step
+        if (currentAmpduValue < ( AGGRESSIVENESS * stepAdjustAmpdu ) ) {
+          // I can only decrease to the minimum
+          newAmpduValue = minimumAmpduValue;
+
+        } else {
+          // decrease a step
+          newAmpduValue = currentAmpduValue - ( AGGRESSIVENESS * stepAdjustAmpdu );
+
+          // make sure that the value is at least the minimum
+          if ( newAmpduValue < minimumAmpduValue )
+            newAmpduValue = minimumAmpduValue;
+        }
+
+      // if the latency is below the latency budget  
+      } else {
+        // increase the AMPDU value to the maximum
+        newAmpduValue = maxAmpduSize;
+      }
+      return newAmpduValue;
+    }
+
+  private:
+    double latencyBudget;
+    uint32_t maxAmpduSize;
+    uint32_t stepAdjustAmpdu;
+};
+
+
+// Dynamically adjust the size of the AMPDU
+// The loop is a template on the controller, so the arithmetic of the selected method is inlined
+template <class AmpduController>
+void adjustAMPDU (const adjustAmpduParameters& myparam,
+                  AmpduController* controller,
+                  uint32_t myNumberAPs)  
+{
+  // Report the STAs that are not associated to any AP
+  if (LOG_ENABLED (1, myparam.verboseLevel)) {
+    for (STA_recordVector::iterator indexSTA = assoc_vector.begin (); indexSTA != assoc_vector.end (); indexSTA++) {
+      if (!indexSTA->GetAssoc())
+        std::cout << Simulator::Now ().GetSeconds() 
+                  << "\t[adjustAMPDU]"
+                  << "\t\tSTA #" << indexSTA->GetStaid() 
+                  << "\tnot associated to any AP" << std::endl;
+    }
+  }
+
+  // For each AP, find the highest value of the delay of the associated STAs
+  for (AP_recordVector::iterator indexAP = AP_vector.begin (); indexAP != AP_vector.end (); indexAP++) {
+    if (LOG_ENABLED (1, myparam.verboseLevel))
+      std::cout << Simulator::Now ().GetSeconds()
+                << "\t[adjustAMPDU]"
+                << "\tAP #" << indexAP->GetApid() 
+                << " with MAC " << indexAP->GetMac() 
+                << " Max size AMPDU " << indexAP->GetMaxSizeAmpdu() 
+                << " Channel " << uint16_t(indexAP->GetWirelessChannel())
+                << std::endl;
+
+    // find the highest latency of all the VoIP STAs associated to that AP
+    double highestLatencyVoIPFlows = 0.0;
+
+    // go through the STAs associated to this AP: first the VoIP ones, and then the rest
+    AP_members& membersOfThisAP = Get_AP_members (indexAP->GetApid());
+
+    for (uint32_t list = 0; list < 2; list++) {
+      STA_recordList& members = (list == 0) ? membersOfThisAP.VoIP : membersOfThisAP.bulk;
+
+      // the STAs not running VoIP are only needed for reporting
+      if ((list == 1) && !LOG_ENABLED (1, myparam.verboseLevel))
+        break;
+
+      for (STA_recordList::const_iterator indexSTA = members.begin (); indexSTA != members.end (); indexSTA++) {
 
-      if (myparam.verboseLevel > 2) {
-        std::cout << Simulator::Now ().GetSeconds()  << '\t';
-        std::cout << "[adjustAMPDU] latencyBudget: " << myparam.latencyBudget << '\t';
-        std::cout << "highest latency: " << highestLatencyVoIPFlows << '\t';
-        std::cout << "currentAmpduValue: " << currentAmpduValue << '\t';
-        std::cout << "belowLatencyAmpduValue: " << *belowLatencyAmpduValue << '\t';
-        std::cout << "aboveLatencyAmpduValue: " << *aboveLatencyAmpduValue << '\t';
-        std::cout << "newAmpduValue: " << newAmpduValue << '\n';
-      }
-    }
+        if (LOG_ENABLED (1, myparam.verboseLevel)) 
+          std::cout << Simulator::Now ().GetSeconds() 
+                    << "\t[adjustAMPDU]"
+                    << "\t\tSTA #" << (*indexSTA)->GetStaid() 
+                    << "\tassociated to AP #" << indexAP->GetApid() 
+                    << "\twith MAC " << (*indexSTA)->GetMacOfitsAP();
+
+        // the flow of the application of this STA
+        int32_t flow = flowTable.GetFlowOfNode ((*indexSTA)->GetStaid());
+        uint16_t typeOfApplication = (*indexSTA)->Gettypeofapplication ();
+
+        if (LOG_ENABLED (1, myparam.verboseLevel)) {
+          if (typeOfApplication == 1)
+            std::cout << "\tVoIP upload";
+          else if (typeOfApplication == 2)
+            std::cout << "\tVoIP download";
+          else if (typeOfApplication == 3)
+            std::cout << "\tTCP upload";
+          else if (typeOfApplication == 4)
+            std::cout << "\tTCP download";
+          else if (typeOfApplication == 5)
+            std::cout << "\tVideo download";
+        }
 
-    // Sixth method for adjusting the AMPDU: drastic increase (instantaneous increase to the maximum) and linear decrease (double aggressiveness, i.e. factor of 2)
-    else if ( myparam.methodAdjustAmpdu == 5 ) {
+        // VoIP
+        if ((flow >= 0) && ((typeOfApplication == 1) || (typeOfApplication == 2))) {
 
-      //  if the latency is above the latency budget
-      if ( highestLatencyVoIPFlows > myparam.latencyBudget ) {
-        // linearly decrease the AMPDU value
+          // 'std::isnan' checks if the value is not a number
+          if (!std::isnan(flowTable.lastIntervalDelay[flow])) {
+            if (LOG_ENABLED (1, myparam.verboseLevel))
+              std::cout << "\tDelay: " << flowTable.lastIntervalDelay[flow]
+                        << "\tThroughput: " << flowTable.lastIntervalRxBytes[flow] * 8 / myparam.timeInterval;
 
-        // check if the current value is smaller than the step
-        if (currentAmpduValue < ( AGGRESSIVENESS * myparam.stepAdjustAmpdu ) ) {
-          // I can only decrease to the minimum
-          newAmpduValue = minimumAmpduValue;
+            // if the latency of this STA is the highest one so far, update the value of the highest latency
+            if (flowTable.lastIntervalDelay[flow] > highestLatencyVoIPFlows)
+              highestLatencyVoIPFlows = flowTable.lastIntervalDelay[flow];
 
-        } else {
-          // decrease a step
-          newAmpduValue = currentAmpduValue - ( AGGRESSIVENESS * myparam.stepAdjustAmpdu );
+          } else {
+            if (LOG_ENABLED (1, myparam.verboseLevel)) 
+              std::cout << "\tDelay not defined in this period";
+          }
 
-          // make sure that the value is at least the minimum
-          if ( newAmpduValue < minimumAmpduValue )
-            newAmpduValue = minimumAmpduValue;
+        // TCP and video: only reported
+        } else if ((flow >= 0) && (LOG_ENABLED (1, myparam.verboseLevel))) {
+          std::cout << ((typeOfApplication == 5) ? "\t\t" : "\t\t\t")
+                    << "\tThroughput: " << flowTable.lastIntervalRxBytes[flow] * 8 / myparam.timeInterval;
         }
 
-      // if the latency is below the latency budget  
-      } else {
-        // increase the AMPDU value to the maximum
-        newAmpduValue = myparam.maxAmpduSize;
+        if (LOG_ENABLED (1, myparam.verboseLevel))           
+          std::cout << "\n";
       }
     }
 
-    // If the selected method does not exist, exit
-    else {
-      std::cout << "AMPDU adjust method unknown\n";
-      exit (1);
-    }
+
+    // Adjust the value of the AMPDU
+
+    // Variable to store the current value of the max AMPDU
+    uint32_t currentAmpduValue = indexAP->GetMaxSizeAmpdu();
+
+    // Variable to store the minimum AMPDU value
+    uint32_t minimumAmpduValue = MTU + 100;
+
+    // Variable to store the new value of the max AMPDU, calculated by the controller of the selected method
+    uint32_t newAmpduValue = controller->NewAmpduValue (highestLatencyVoIPFlows, currentAmpduValue, minimumAmpduValue);
 
     // write the AMPDU value to a file (it is written at the end of the file)
     if ( myparam.mynameAMPDUFile != "" ) {
 
-      std::ofstream ofsAMPDU;
-      ofsAMPDU.open ( myparam.mynameAMPDUFile, std::ofstream::out | std::ofstream::app); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
-
-      ofsAMPDU << Simulator::Now().GetSeconds() << "\t";    // timestamp
-      ofsAMPDU << GetAnAP_Id((*indexAP)->GetMac()) << "\t"; // write the ID of the AP to the file
-      ofsAMPDU << "AP\t";                                   // type of node
-      ofsAMPDU << "-\t";                                    // It is not associated to any AP, since it is an AP
-      ofsAMPDU << newAmpduValue << "\n";                    // new value of the AMPDU
+      rowSink.Find (myparam.mynameAMPDUFile)->Double (Simulator::Now().GetSeconds())   // timestamp
+                                            .Uint (indexAP->GetApid())            // ID of the AP
+                                            .Enum (0)                                // type of node: AP
+                                            .Null ()                                 // It is not associated to any AP, since it is an AP
+                                            .Uint (newAmpduValue)                    // new value of the AMPDU
+                                            .EndRow ();
     }
 
     // Check if the AMPDU has to be modified or not
     if (newAmpduValue == currentAmpduValue) {
 
       // Report that the AMPDU has not been modified
-      if (myparam.verboseLevel > 0)
+      if (LOG_ENABLED (1, myparam.verboseLevel))
         std::cout << Simulator::Now ().GetSeconds()
                   << "\t[adjustAMPDU]"
-                  //<< "\tAP #" << GetAnAP_Id((*indexAP)->GetMac())
+                  //<< "\tAP #" << indexAP->GetApid()
                   << "\t\tHighest Latency of VoIP flows: " << highestLatencyVoIPFlows << "s (limit " << myparam.latencyBudget << " s)"
-                  //<< "\twith MAC: " << (*indexAP)->GetMac() 
-                  << "\tAMPDU of the AP not changed (" << (*indexAP)->GetMaxSizeAmpdu() << ")"
+                  //<< "\twith MAC: " << indexAP->GetMac() 
+                  << "\tAMPDU of the AP not changed (" << indexAP->GetMaxSizeAmpdu() << ")"
                   << std::endl;
 
     // the AMPDU of the AP has to be modified
     } else {
 
       // Modify the AMPDU value of the AP itself
-      ModifyAmpdu ( GetAnAP_Id((*indexAP)->GetMac()), newAmpduValue, 1 );
-      Modify_AP_Record (GetAnAP_Id((*indexAP)->GetMac()), (*indexAP)->GetMac(), newAmpduValue );
+      ModifyAmpdu ( indexAP->GetApid(), newAmpduValue, 1 );
+      Modify_AP_Record (indexAP->GetApid(), indexAP->GetMac(), newAmpduValue );
+      TRACE_EVENT (TRACE_AMPDU_AP, indexAP->GetApid(), 0, newAmpduValue);
 
       // Report the AMPDU modification
-      if (myparam.verboseLevel > 0) {
+      if (LOG_ENABLED (1, myparam.verboseLevel)) {
         std::cout << Simulator::Now ().GetSeconds()
                   << "\t[adjustAMPDU]"
-                  //<< "\tAP #" << GetAnAP_Id((*indexAP)->GetMac())
+                  //<< "\tAP #" << indexAP->GetApid()
                   << "\t\tHighest Latency of VoIP flows: " << highestLatencyVoIPFlows;
-                  //<< "\twith MAC: " << (*indexAP)->GetMac();
+                  //<< "\twith MAC: " << indexAP->GetMac();
 
         if ( newAmpduValue > currentAmpduValue )
-          std::cout << "\tAMPDU of the AP increased to " << (*indexAP)->GetMaxSizeAmpdu();
+          std::cout << "\tAMPDU of the AP increased to " << indexAP->GetMaxSizeAmpdu();
         else 
-          std::cout << "\tAMPDU of the AP reduced to " << (*indexAP)->GetMaxSizeAmpdu();
+          std::cout << "\tAMPDU of the AP reduced to " << indexAP->GetMaxSizeAmpdu();
 
         std::cout << std::endl;
       }
 
 
       // Modify the AMPDU value of the STAs associated to the AP which are NOT running VoIP (VoIP STAs never use aggregation)
-      for (STA_recordVector::const_iterator indexSTA = assoc_vector.begin (); indexSTA != assoc_vector.end (); indexSTA++) {
+      for (STA_recordList::const_iterator indexSTA = membersOfThisAP.bulk.begin (); indexSTA != membersOfThisAP.bulk.end (); indexSTA++) {
+        // modify the AMPDU value
+        ModifyAmpdu ((*indexSTA)->GetStaid(), newAmpduValue, 1);  // modify the AMPDU in the STA node
+        (*indexSTA)->SetMaxSizeAmpdu(newAmpduValue);              // update the data in the STA_record structure
+        TRACE_EVENT (TRACE_AMPDU_STA, (*indexSTA)->GetStaid(), indexAP->GetApid(), newAmpduValue);
+
+        // Report this modification
+        if (LOG_ENABLED (1, myparam.verboseLevel)) {
+          std::cout << Simulator::Now ().GetSeconds() 
+                    << "\t[adjustAMPDU]"
+                    << "\t\t\tSTA #" << (*indexSTA)->GetStaid() 
+                    //<< "\tassociated to AP #" << indexAP->GetApid() 
+                    //<< "\twith MAC " << (*indexSTA)->GetMacOfitsAP()
+                    ;
+
+          if ((*indexSTA)->Gettypeofapplication () == 3)
+            std::cout << "\t TCP upload";
+          else if ((*indexSTA)->Gettypeofapplication () == 4)
+            std::cout << "\t TCP download";
+          else if ((*indexSTA)->Gettypeofapplication () == 5)
+            std::cout << "\t Video download";
+
+          if ( newAmpduValue > currentAmpduValue )
+            std::cout << "\t\tAMPDU of the STA increased to " << newAmpduValue;
+          else 
+            std::cout << "\t\tAMPDU of the STA reduced to " << newAmpduValue;
+
+          std::cout << "\n";              
+        }
 
-        // if the STA is associated
-        if ((*indexSTA)->GetAssoc()) {
+        // write the new AMPDU value to a file (it is written at the end of the file)
+        if ( myparam.mynameAMPDUFile != "" ) {
 
-          // if the STA is NOT running VoIP
-          if ( ( (*indexSTA)->Gettypeofapplication () > 2) ) {
+          rowSink.Find (myparam.mynameAMPDUFile)->Double (Simulator::Now().GetSeconds())   // timestamp
+                                                .Uint ((*indexSTA)->GetStaid())          // ID of the STA
+                                                .Enum (1)                                // type of node: STA
+                                                .Uint (indexAP->GetApid())            // AP where it is associated
+                                                .Uint (newAmpduValue)                    // new value of the AMPDU
+                                                .EndRow ();
+        }
+      }
+    }
+  }
+}
 
-            // auxiliar string
-            std::ostringstream auxString;
-            // create a string with the MAC
-            auxString << "02-06-" << (*indexSTA)->GetMacOfitsAP();
-            std::string addressOfTheAPwhereThisSTAis = auxString.str();
+// Periodic task of the adjustment of the AMPDU. It owns the controller of the selected method
+template <class AmpduController>
+class AdjustAmpduTask : public PeriodicTask
+{
+  public:
+    AdjustAmpduTask (adjustAmpduParameters thisParam, uint32_t thisNumberAPs);
+  protected:
+    void Run ();
+    std::string GetName () const { return "adjustAMPDU"; }
+  private:
+    adjustAmpduParameters myparam;
+    AmpduController controller;
+    uint32_t myNumberAPs;
+};
 
-            // if the STA is associated to this AP
-            if ( (*indexAP)->GetMac() == addressOfTheAPwhereThisSTAis ) {
-              // modify the AMPDU value
-              ModifyAmpdu ((*indexSTA)->GetStaid(), newAmpduValue, 1);  // modify the AMPDU in the STA node
-              (*indexSTA)->SetMaxSizeAmpdu(newAmpduValue);              // update the data in the STA_record structure
+template <class AmpduController>
+AdjustAmpduTask<AmpduController>::AdjustAmpduTask (adjustAmpduParameters thisParam, uint32_t thisNumberAPs)
+  : myparam (thisParam),
+    controller (thisParam),
+    myNumberAPs (thisNumberAPs)
+{
+}
 
-              // Report this modification
-              if (myparam.verboseLevel > 0) {
-                std::cout << Simulator::Now ().GetSeconds() 
-                          << "\t[adjustAMPDU]"
-                          << "\t\t\tSTA #" << (*indexSTA)->GetStaid() 
-                          //<< "\tassociated to AP #" << GetAnAP_Id(addressOfTheAPwhereThisSTAis) 
-                          //<< "\twith MAC " << (*indexSTA)->GetMacOfitsAP()
-                          ;
-
-                if ((*indexSTA)->Gettypeofapplication () == 3)
-                  std::cout << "\t TCP upload";
-                else if ((*indexSTA)->Gettypeofapplication () == 4)
-                  std::cout << "\t TCP download";
-                else if ((*indexSTA)->Gettypeofapplication () == 5)
-                  std::cout << "\t Video download";
-
-                if ( newAmpduValue > currentAmpduValue )
-                  std::cout << "\t\tAMPDU of the STA increased to " << newAmpduValue;
-                else 
-                  std::cout << "\t\tAMPDU of the STA reduced to " << newAmpduValue;
-
-                std::cout << "\n";              
-              }
+template <class AmpduController>
+void
+AdjustAmpduTask<AmpduController>::Run ()
+{
+  adjustAMPDU<AmpduController> (myparam, &controller, myNumberAPs);
+}
 
-              // write the new AMPDU value to a file (it is written at the end of the file)
-              if ( myparam.mynameAMPDUFile != "" ) {
 
-                std::ofstream ofsAMPDU;
-                ofsAMPDU.open ( myparam.mynameAMPDUFile, std::ofstream::out | std::ofstream::app); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
+// Registry of the AMPDU controllers. The key is the value of 'methodAdjustAmpdu'
+// A new controller is a class with a constructor that takes the adjustAmpduParameters, and the function
+//    uint32_t NewAmpduValue (double highestLatencyVoIPFlows, uint32_t currentAmpduValue, uint32_t minimumAmpduValue)
+// It is added with a call to RegisterAmpduController<> in RegisterAmpduControllers (). The loop does not change
+typedef void (*AmpduControllerStart) (adjustAmpduParameters myparam, uint32_t myNumberAPs, double startTime);
+typedef double (*AmpduControllerBenchmark) (adjustAmpduParameters myparam, uint32_t iterations, uint64_t* checksum);
 
-                ofsAMPDU << Simulator::Now().GetSeconds() << "\t";    // timestamp
-                ofsAMPDU << (*indexSTA)->GetStaid() << "\t";          // ID of the AP
-                ofsAMPDU << "STA \t";
-                ofsAMPDU << GetAnAP_Id((*indexAP)->GetMac()) << "\t";
-                ofsAMPDU << newAmpduValue << "\n";                    // new value of the AMPDU
-              }
-            }
-          }
-        }
-      }
-    }
+struct AmpduControllerEntry {
+  std::string name;
+  AmpduControllerStart start;
+  AmpduControllerBenchmark benchmark;
+};
+
+std::map<uint16_t, AmpduControllerEntry> AmpduControllerRegistry;
+
+// create the task with the controller and schedule the first run of the loop. It is deleted when the simulator is destroyed
+template <class AmpduController>
+void
+StartAmpduController (adjustAmpduParameters myparam, uint32_t myNumberAPs, double startTime)
+{
+  periodicTasks.Start (new AdjustAmpduTask<AmpduController> (myparam, myNumberAPs), startTime, myparam.timeInterval);
+}
+
+// Microbenchmark of a controller: it is run with a synthetic series of latencies around the latency budget,
+// without the simulator. It returns the time per call [ns]. The checksum of the AMPDU values avoids that the compiler removes the calls
+template <class AmpduController>
+double
+BenchmarkAmpduController (adjustAmpduParameters myparam, uint32_t iterations, uint64_t* checksum)
+{
+  myparam.verboseLevel = 0;
+  AmpduController controller (myparam);
+
+  // the latencies are generated in advance, so the generator is not measured
+  std::vector<double> latencies (1024);
+  uint32_t seed = 12345;
+  for (uint32_t i = 0; i < latencies.size (); i++) {
+    seed = seed * 1103515245 + 12345;
+    latencies[i] = myparam.latencyBudget * (0.5 + (seed >> 16) / 65536.0); // between 0.5 and 1.5 times the budget
+  }
+
+  uint32_t minimumAmpduValue = MTU + 100;
+  uint32_t ampduValue = myparam.maxAmpduSize;
+  uint64_t sum = 0;
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < iterations; i++) {
+    ampduValue = controller.NewAmpduValue (latencies[i & 1023], ampduValue, minimumAmpduValue);
+    sum += ampduValue;
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+
+  *checksum = sum;
+  return std::chrono::duration<double, std::nano> (end - begin).count () / iterations;
+}
+
+template <class AmpduController>
+void
+RegisterAmpduController (uint16_t method, std::string name)
+{
+  AmpduControllerEntry entry;
+  entry.name = name;
+  entry.start = &StartAmpduController<AmpduController>;
+  entry.benchmark = &BenchmarkAmpduController<AmpduController>;
+  AmpduControllerRegistry[method] = entry;
+}
+
+// the methods that can be selected with 'methodAdjustAmpdu'
+void
+RegisterAmpduControllers ()
+{
+  RegisterAmpduController<AmpduControllerLinear> (0, "linear");
+  RegisterAmpduController<AmpduControllerDrasticReset> (1, "drastic reset");
+  RegisterAmpduController<AmpduControllerGeometric> (2, "geometric");
+  RegisterAmpduController<AmpduControllerGoldenRatio> (3, "golden ratio");
+  RegisterAmpduController<AmpduControllerBisection> (4, "bisection");
+  RegisterAmpduController<AmpduControllerJumpToMax> (5, "linear drop, jump to max");
+}
+
+// run the microbenchmark of all the registered controllers, and print the results
+void
+BenchmarkAmpduControllers (adjustAmpduParameters myparam, uint32_t iterations)
+{
+  std::cout << "method\tcontroller\tns per call\tchecksum\n";
+  for (std::map<uint16_t, AmpduControllerEntry>::const_iterator i = AmpduControllerRegistry.begin (); i != AmpduControllerRegistry.end (); ++i) {
+    uint64_t checksum;
+    double nsPerCall = i->second.benchmark (myparam, iterations, &checksum);
+    std::cout << i->first << "\t"
+              << i->second.name << "\t"
+              << nsPerCall << "\t"
+              << checksum << "\n";
   }
+}
+
+
+// Periodically obtain the statistics of all the flows, using Flowmonitor
+// A single event per interval updates the flows of the five types
+// Each FlowId is classified only once (the first time it appears), and it is linked to its flow
+// in flowTable. The statistics of FlowMonitor are read by reference, not copied
+class KPI_collector : public PeriodicTask
+{
+  public:
+    KPI_collector ();
+    void Setup (Ptr<FlowMonitor> thisMonitor, uint32_t thisVerboseLevel, double thisTimeInterval);
+  protected:
+    void Run ();
+    std::string GetName () const { return "obtainKPIs"; }
+  private:
+    struct flowSlot {
+      bool classified;
+      int32_t flow;                 // the flow in flowTable. -1: not monitored
+    };
+    flowSlot& GetSlot (FlowId flowId);
+    Ptr<FlowMonitor> monitor;
+    Ptr<Ipv4FlowClassifier> classifier;
+    uint32_t verboseLevel;
+    double timeInterval;
+    std::vector<flowSlot> slots;    // indexed by FlowId
+};
 
-  // Reschedule the calculation
-  Simulator::Schedule(  Seconds(myparam.timeInterval),
-                        &adjustAMPDU,
-                        myAllTheFlowStatistics,
-                        myparam,
-                        belowLatencyAmpduValue,
-                        aboveLatencyAmpduValue,
-                        myNumberAPs);
+KPI_collector::KPI_collector ()
+{
+  verboseLevel = 0;
+  timeInterval = 0.0;
 }
 
+void
+KPI_collector::Setup (Ptr<FlowMonitor> thisMonitor, uint32_t thisVerboseLevel, double thisTimeInterval)
+{
+  monitor = thisMonitor;
+  classifier = DynamicCast<Ipv4FlowClassifier> (flowmon->GetClassifier ());
+  verboseLevel = thisVerboseLevel;
+  timeInterval = thisTimeInterval;
+
+  // FlowMonitor assigns consecutive FlowIds, starting from 1. There are two flows per application at most (data and ACKs)
+  flowSlot notClassified = { false, -1 };
+  slots.assign (2 * flowTable.GetNumberFlows () + 1, notClassified);
+}
 
-// Periodically obtain the statistics of the VoIP flows, using Flowmonitor
-void obtainKPIs (Ptr<FlowMonitor> monitor/*, FlowMonitorHelper flowmon*/, 
-                  FlowStatistics* myFlowStatistics,
-                  uint16_t typeOfFlow,
-                  uint32_t verboseLevel,
-                  double timeInterval)  //Interval between monitoring moments
+KPI_collector::flowSlot&
+KPI_collector::GetSlot (FlowId flowId)
 {
+  if (flowId >= slots.size ()) {
+    flowSlot notClassified = { false, -1 };
+    slots.resize (flowId + 1, notClassified);
+  }
+
+  flowSlot& slot = slots[flowId];
+  if (!slot.classified) {
+    slot.classified = true;
 
-  monitor->CheckForLostPackets ();
-  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
-  std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats ();
+    // the flows of ACKs (TCP also generates these kind of flows) are not in the table, so they are not monitored
+    Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (flowId);
+    slot.flow = flowTable.GetFlowOfPort (t.destinationPort);
+  }
+  return slot;
+}
 
-  uint16_t k = 0;
+void
+KPI_collector::Run ()
+{
+  // the time spent by FlowMonitor has its own line in the table of the profiler
+  static uint32_t profilerEntryFlowMonitor = callbackProfiler.GetEntry ("obtainKPIs: FlowMonitor");
+  {
+    ProfileScope profile (profilerEntryFlowMonitor);
+    monitor->CheckForLostPackets ();
+  }
+  const std::map<FlowId, FlowMonitor::FlowStats>& stats = monitor->GetFlowStats ();
+  TRACE_EVENT (TRACE_KPI, stats.size (), 0, 0);
 
   // for each flow, obtain and update the statistics
   for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i) {
 
-    Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
-
-    uint32_t RxPacketsThisInterval;
-    uint32_t lostPacketsThisInterval;
-    uint32_t RxBytesThisInterval;
-    double averageLatencyThisInterval;
-    double averageJitterThisInterval;
-
-    //std::cout << "Flow #" << k << "destinationPort: " << t.destinationPort << "/10000 = " << t.destinationPort / 10000 << "\n";
-
-    // avoid the flows of ACKs (TCP also generates these kind of flows)
-    if (t.destinationPort != 49153) {
-      if (t.destinationPort / 10000 == typeOfFlow ) {
-        // obtain the average latency and jitter only in the last interval
-        RxPacketsThisInterval = i->second.rxPackets - myFlowStatistics[k].acumRxPackets;
-        lostPacketsThisInterval = i->second.lostPackets - myFlowStatistics[k].acumLostPackets;
-        RxBytesThisInterval = i->second.rxBytes - myFlowStatistics[k].acumRxBytes;
-        averageLatencyThisInterval = (i->second.delaySum.GetSeconds() - myFlowStatistics[k].acumDelay) / RxPacketsThisInterval;
-        averageJitterThisInterval = (i->second.jitterSum.GetSeconds() - myFlowStatistics[k].acumJitter) / RxPacketsThisInterval;
-
-        // update the values of the statistics      
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].acumDelay = i->second.delaySum.GetSeconds();
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].acumJitter = i->second.jitterSum.GetSeconds();
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].acumRxPackets = i->second.rxPackets;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].acumLostPackets = i->second.lostPackets;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].acumRxBytes = i->second.rxBytes;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].lastIntervalDelay = averageLatencyThisInterval;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].lastIntervalJitter = averageJitterThisInterval;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].lastIntervalRxPackets = RxPacketsThisInterval;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].lastIntervalLostPackets = lostPacketsThisInterval;
-        myFlowStatistics[t.destinationPort % (10000 * typeOfFlow)].lastIntervalRxBytes = RxBytesThisInterval;
-
-        k++;
-
-        if (verboseLevel > 1) {
-
-          std::cout << Simulator::Now().GetSeconds();
-          std::cout << "\t[obtainKPIs] flow " << i->first;
-
-          if (t.destinationPort / 10000 == 1 )
-            std::cout << "\tVoIP upload\n";
-          else if (t.destinationPort / 10000 == 2 )
-            std::cout << "\tVoIP download\n";
-          else if (t.destinationPort / 10000 == 3 )
-            std::cout << "\tTCP upload\n";
-          else if (t.destinationPort / 10000 == 4 )
-            std::cout << "\tTCP download\n";
-          else if (t.destinationPort / 10000 == 5 )
-            std::cout << "\tVideo download\n";
-
-          if (verboseLevel > 2) {
-            std::cout << "\t\t\tAcum delay at the end of the period: " << i->second.delaySum.GetSeconds() << " [s]\n";
-            std::cout << "\t\t\tAcum number of Rx packets: " << i->second.rxPackets << "\n";
-            std::cout << "\t\t\tAcum number of Rx bytes: " << i->second.rxBytes << "\n";
-            std::cout << "\t\t\tAcum number of lost packets: " << i->second.lostPackets << "\n"; // FIXME
-            std::cout << "\t\t\tAcum throughput: " << i->second.rxBytes * 8.0 / (Simulator::Now().GetSeconds() - INITIALTIMEINTERVAL) << "  [bps]\n";  // throughput
-            //The previous line does not work correctly. If you add 'monitor->CheckForLostPackets (0.01)' at the beginning of the function, the number
-            //of lost packets seems to be higher. However, the obtained number does not correspond to the final number
-          }
-          std::cout << "\t\t\tAverage delay this period: " << averageLatencyThisInterval << " [s]\n";
-          std::cout << "\t\t\tAverage jitter this period: " << averageJitterThisInterval << " [s]\n";
-          std::cout << "\t\t\tNumber of Rx packets this period: " << RxPacketsThisInterval << "\n";
-          std::cout << "\t\t\tNumber of Rx bytes this period: " << RxBytesThisInterval << "\n";
-          std::cout << "\t\t\tNumber of lost packets this period: " << lostPacketsThisInterval << "\n"; // FIXME: This does not work correctly
-          std::cout << "\t\t\tThroughput this period: " << RxBytesThisInterval * 8.0 / timeInterval << "  [bps]\n\n";  // throughput
-          //std::cout << "\tt\tk= " << k << "\n";
-        }
+    flowSlot& slot = GetSlot (i->first);
+    if (slot.flow < 0)
+      continue;
+
+    uint32_t flow = slot.flow;
+
+    // obtain the average latency and jitter only in the last interval
+    uint32_t RxPacketsThisInterval = i->second.rxPackets - flowTable.acumRxPackets[flow];
+    uint32_t lostPacketsThisInterval = i->second.lostPackets - flowTable.acumLostPackets[flow];
+    uint32_t RxBytesThisInterval = i->second.rxBytes - flowTable.acumRxBytes[flow];
+    double averageLatencyThisInterval = (i->second.delaySum.GetSeconds() - flowTable.acumDelay[flow]) / RxPacketsThisInterval;
+    double averageJitterThisInterval = (i->second.jitterSum.GetSeconds() - flowTable.acumJitter[flow]) / RxPacketsThisInterval;
+
+    // update the values of the statistics      
+    flowTable.acumDelay[flow] = i->second.delaySum.GetSeconds();
+    flowTable.acumJitter[flow] = i->second.jitterSum.GetSeconds();
+    flowTable.acumRxPackets[flow] = i->second.rxPackets;
+    flowTable.acumLostPackets[flow] = i->second.lostPackets;
+    flowTable.acumRxBytes[flow] = i->second.rxBytes;
+    flowTable.lastIntervalDelay[flow] = averageLatencyThisInterval;
+    flowTable.lastIntervalJitter[flow] = averageJitterThisInterval;
+    flowTable.lastIntervalRxPackets[flow] = RxPacketsThisInterval;
+    flowTable.lastIntervalLostPackets[flow] = lostPacketsThisInterval;
+    flowTable.lastIntervalRxBytes[flow] = RxBytesThisInterval;
+
+    if (LOG_ENABLED (2, verboseLevel)) {
+
+      std::cout << Simulator::Now().GetSeconds();
+      std::cout << "\t[KPI_collector] flow " << i->first;
+
+      if (flowTable.type[flow] == 1 )
+        std::cout << "\tVoIP upload\n";
+      else if (flowTable.type[flow] == 2 )
+        std::cout << "\tVoIP download\n";
+      else if (flowTable.type[flow] == 3 )
+        std::cout << "\tTCP upload\n";
+      else if (flowTable.type[flow] == 4 )
+        std::cout << "\tTCP download\n";
+      else if (flowTable.type[flow] == 5 )
+        std::cout << "\tVideo download\n";
+
+      if (LOG_ENABLED (3, verboseLevel)) {
+        std::cout << "\t\t\tAcum delay at the end of the period: " << i->second.delaySum.GetSeconds() << " [s]\n";
+        std::cout << "\t\t\tAcum number of Rx packets: " << i->second.rxPackets << "\n";
+        std::cout << "\t\t\tAcum number of Rx bytes: " << i->second.rxBytes << "\n";
+        std::cout << "\t\t\tAcum number of lost packets: " << i->second.lostPackets << "\n"; // FIXME
+        std::cout << "\t\t\tAcum throughput: " << i->second.rxBytes * 8.0 / (Simulator::Now().GetSeconds() - INITIALTIMEINTERVAL) << "  [bps]\n";  // throughput
+        //The previous line does not work correctly. If you add 'monitor->CheckForLostPackets (0.01)' at the beginning of the function, the number
+        //of lost packets seems to be higher. However, the obtained number does not correspond to the final number
       }
+      std::cout << "\t\t\tAverage delay this period: " << averageLatencyThisInterval << " [s]\n";
+      std::cout << "\t\t\tAverage jitter this period: " << averageJitterThisInterval << " [s]\n";
+      std::cout << "\t\t\tNumber of Rx packets this period: " << RxPacketsThisInterval << "\n";
+      std::cout << "\t\t\tNumber of Rx bytes this period: " << RxBytesThisInterval << "\n";
+      std::cout << "\t\t\tNumber of lost packets this period: " << lostPacketsThisInterval << "\n"; // FIXME: This does not work correctly
+      std::cout << "\t\t\tThroughput this period: " << RxBytesThisInterval * 8.0 / timeInterval << "  [bps]\n\n";  // throughput
     }
   }
-
-  // Reschedule the calculation
-  Simulator::Schedule(  Seconds(timeInterval),
-                        &obtainKPIs,
-                        monitor/*, flowmon*/, 
-                        myFlowStatistics,
-                        typeOfFlow,
-                        verboseLevel,
-                        timeInterval);
 }
 
+KPI_collector kpiCollector;
+
+
+// Label of each type of flow in the KPI file (type - 1)
+const char* KPIapplicationLabels[5] = { "VoIP_upload", "VoIP_download", "TCP_upload", "TCP_download", "Video_download" };
+
+// Periodically write the statistics of the flows, obtained by kpiCollector, to a file
+class SaveKPIsTask : public PeriodicTask
+{
+  public:
+    SaveKPIsTask (std::string thisNameKPIFile, double thisTimeInterval);
+  protected:
+    void Run ();
+    std::string GetName () const { return "saveKPIs"; }
+  private:
+    std::string mynameKPIFile;
+    double timeInterval;  //Interval between monitoring moments
+};
+
+SaveKPIsTask::SaveKPIsTask (std::string thisNameKPIFile, double thisTimeInterval)
+{
+  mynameKPIFile = thisNameKPIFile;
+  timeInterval = thisTimeInterval;
+}
 
-// Periodically obtain the statistics of the VoIP flows, using Flowmonitor
-void saveKPIs ( std::string mynameKPIFile,
-                AllTheFlowStatistics myAllTheFlowStatistics,
-                uint32_t verboseLevel,
-                double timeInterval)  //Interval between monitoring moments
+void
+SaveKPIsTask::Run ()
 {
   // print the results to a file (they are written at the end of the file)
   if ( mynameKPIFile != "" ) {
 
-    std::ofstream ofs;
-    ofs.open ( mynameKPIFile, std::ofstream::out | std::ofstream::app); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
-
-    for (uint32_t i = 0; i < myAllTheFlowStatistics.numberVoIPUploadFlows; i++) {
-      ofs << Simulator::Now().GetSeconds() << "\t"; // timestamp
-      ofs << i << "\t"; // number of the flow
-      ofs << "VoIP_upload\t";
-      ofs << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].destinationPort << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].lastIntervalDelay << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].lastIntervalJitter << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].lastIntervalRxPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].lastIntervalLostPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPUpload[i].lastIntervalRxBytes * 8.0 / timeInterval << "\n"; // throughput
-    }
-
-    for (uint32_t i = 0; i < myAllTheFlowStatistics.numberVoIPDownloadFlows; i++) {
-      ofs << Simulator::Now().GetSeconds() << "\t"; // timestamp
-      ofs << i
-              + myAllTheFlowStatistics.numberVoIPUploadFlows << "\t"; // number of the flow
-      ofs << "VoIP_download\t";
-      ofs << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].destinationPort << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].lastIntervalDelay << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].lastIntervalJitter << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].lastIntervalRxPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].lastIntervalLostPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVoIPDownload[i].lastIntervalRxBytes * 8.0 / timeInterval << "\n"; // throughput
-    }
-
-    for (uint32_t i = 0; i < myAllTheFlowStatistics.numberTCPUploadFlows; i++) {
-      ofs << Simulator::Now().GetSeconds() << "\t"; // timestamp
-      ofs << i 
-              + myAllTheFlowStatistics.numberVoIPUploadFlows 
-              + myAllTheFlowStatistics.numberVoIPDownloadFlows << "\t"; // number of the flow
-      ofs << "TCP_upload\t";
-      ofs << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].destinationPort << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].lastIntervalDelay << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].lastIntervalJitter << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].lastIntervalRxPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].lastIntervalLostPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPUpload[i].lastIntervalRxBytes * 8.0 / timeInterval << "\n"; // throughput
-    }
-
-    for (uint32_t i = 0; i < myAllTheFlowStatistics.numberTCPDownloadFlows; i++) {
-      ofs << Simulator::Now().GetSeconds() << "\t"; // timestamp
-      ofs << i 
-              + myAllTheFlowStatistics.numberVoIPUploadFlows 
-              + myAllTheFlowStatistics.numberVoIPDownloadFlows 
-              + myAllTheFlowStatistics.numberTCPUploadFlows << "\t"; // number of the flow
-      ofs << "TCP_download\t";
-      ofs << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].destinationPort << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].lastIntervalDelay << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].lastIntervalJitter << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].lastIntervalRxPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].lastIntervalLostPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsTCPDownload[i].lastIntervalRxBytes * 8.0 / timeInterval << "\n"; // throughput
-    }
-
-    for (uint32_t i = 0; i < myAllTheFlowStatistics.numberVideoDownloadFlows; i++) {
-      ofs << Simulator::Now().GetSeconds() << "\t"; // timestamp
-      ofs << i  
-              + myAllTheFlowStatistics.numberVoIPUploadFlows 
-              + myAllTheFlowStatistics.numberVoIPDownloadFlows 
-              + myAllTheFlowStatistics.numberTCPUploadFlows 
-              + myAllTheFlowStatistics.numberTCPDownloadFlows << "\t"; // number of the flow
-      ofs << "Video_download\t"; 
-      ofs << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].destinationPort << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].lastIntervalDelay << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].lastIntervalJitter << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].lastIntervalRxPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].lastIntervalLostPackets << "\t"
-          << myAllTheFlowStatistics.FlowStatisticsVideoDownload[i].lastIntervalRxBytes * 8.0 / timeInterval << "\n"; // throughput
-    }
-  }
-
-  // Reschedule the writing
-  Simulator::Schedule(  Seconds(timeInterval),
-                        &saveKPIs,
-                        mynameKPIFile,
-                        myAllTheFlowStatistics,
-                        verboseLevel,
-                        timeInterval);
+    // the file is kept open until the end (text or columnar)
+    RowWriter* writer = rowSink.Find (mynameKPIFile);
+
+    double now = Simulator::Now().GetSeconds();
+
+    for (uint32_t flow = 0; flow < flowTable.GetNumberFlows (); flow++) {
+      double throughput = flowTable.lastIntervalRxBytes[flow] * 8.0 / timeInterval;
+
+      writer->Double (now)                                    // timestamp
+             .Uint (flow)                                     // number of the flow
+             .Enum (flowTable.type[flow] - 1)                 // application
+             .Uint (flowTable.destinationPort[flow])
+             .Double (flowTable.lastIntervalDelay[flow])
+             .Double (flowTable.lastIntervalJitter[flow])
+             .Uint (flowTable.lastIntervalRxPackets[flow])
+             .Uint (flowTable.lastIntervalLostPackets[flow])
+             .Double (throughput)
+             .EndRow ();
+    }
+  }
 }
 
 
 /*****************************/
 /************ main ***********/
 /*****************************/
-int main (int argc, char *argv[]) {
+// Run a realization of the scenario. It is called once per replication.
+// 'numberReplications' is only updated when the replication finishes correctly
+static int
+runReplication (int argc, char *argv[], uint32_t replication, uint32_t* numberReplications, uint64_t* firstRun)
+{
+  // each replication starts with a new FlowMonitorHelper, since the previous one has the flows of the destroyed nodes
+  flowmon = new FlowMonitorHelper;
+
+  // wall clock time at the beginning, for the benchmark
+  std::chrono::steady_clock::time_point wallClockStart = std::chrono::steady_clock::now ();
 
   //bool populatearpcache = false; // Provisional variable FIXME: It should not be necessary
 
@@ -3312,6 +5162,19 @@ int main (int argc, char *argv[]) {
   std::string outputFileName; // the beginning of the name of the output files to be generated during the simulations
   std::string outputFileSurname; // this will be added to certain files
   bool saveXMLFile = false; // save per-flow results in an XML file
+  uint32_t kpiBufferSize = 1 << 20; // size of the write buffer of each periodic output file (bytes)
+  bool binaryOutput = false; // write the KPI, AMPDU and position files in columnar binary format ('.col') instead of text
+  double kpiFlushPeriod = 10.0; // the periodic output files are written to disk at least every 'kpiFlushPeriod' simulation seconds
+  std::string benchmarkFileName = ""; // if it is not empty, the wall time, number of events and memory of the run are added to this file
+  uint32_t traceRingSize = 0; // number of events kept in the trace ring. '0' means no trace
+  std::string traceRingFile = ""; // if it is not empty, the trace ring is written to this file at the end
+  bool asynchronousOutput = false; // the periodic files and the mobility trace are formatted and written by a separate thread
+  std::string resultsFolder = ""; // if it is not empty, the results are written to a file of this folder, instead of '_average.txt'
+  std::string resultsPoint = ""; // point of the sweep to which this run belongs, in the results file. By default, outputFileSurname
+  bool profileCallbacks = false; // measure the wall time and allocations of the callbacks of this script, and write them to '_profile.txt'
+  uint32_t replications = 1; // number of realizations to be run in this process, with consecutive values of RngRun
+  uint32_t forkRuns = 1; // number of child processes that run the scenario, after it has been built once, with consecutive values of RngRun
+  uint32_t forkJobs = 0; // maximum number of children running at the same time. '0' means the number of cores
 
   uint32_t numOperationalChannels = 4; // by default, 4 different channels are used in the APs
   uint32_t numOperationalChannelsSecondary = 4; // by default, 4 different channels are used in the APs
@@ -3332,6 +5195,12 @@ int main (int argc, char *argv[]) {
 
   uint32_t stepAdjustAmpdu = STEPADJUSTAMPDUDEFAULT; // step for adjusting the AMPDU size. Assign the default value
 
+  uint32_t benchmarkAmpduControllers = 0; // if it is not 0, only the microbenchmark of the AMPDU controllers is run, with this number of iterations
+
+  double ampduGrowthFactor = AMPDUGROWTHFACTORDEFAULT; // method 3: factor for increasing the AMPDU size. Assign the default value
+
+  double ampduShrinkFactor = AMPDUSHRINKFACTORDEFAULT; // method 3: factor for decreasing the AMPDU size. Assign the default value
+
   bool defineAPsManually = false;   // Define APs positions, versions and parameters manually in the program
                                 // if set to 1, the value of version80211primary, numOperationalChannels and channelWidth has to be defined manually in the program
 
@@ -3435,8 +5304,11 @@ int main (int argc, char *argv[]) {
   // This algorithm dynamically adjusts AMPDU trying to keep VoIP latency below a threshold ('latencyBudget')
   cmd.AddValue ("aggregationDynamicAlgorithm", "Is the algorithm dynamically adapting AMPDU aggregation enabled?", aggregationDynamicAlgorithm);
   cmd.AddValue ("latencyBudget", "Maximum latency [s] tolerated by VoIP applications", latencyBudget);
-  cmd.AddValue ("methodAdjustAmpdu", "Method for adjusting AMPDU size: '0' (default), '1' ...", methodAdjustAmpdu);
+  cmd.AddValue ("methodAdjustAmpdu", "Method for adjusting AMPDU size: '0' linear (default), '1' drastic reset, '2' geometric, '3' golden ratio, '4' bisection, '5' linear drop and jump to max", methodAdjustAmpdu);
+  cmd.AddValue ("benchmarkAmpduControllers", "If not 0, do not simulate: only run the microbenchmark of the AMPDU controllers, with this number of iterations", benchmarkAmpduControllers);
   cmd.AddValue ("stepAdjustAmpdu", "Step for adjusting AMPDU size [bytes]", stepAdjustAmpdu);
+  cmd.AddValue ("ampduGrowthFactor", "Method 3: factor for increasing AMPDU size when the latency is below the budget, e.g. 2, 1.618, 2.618", ampduGrowthFactor);
+  cmd.AddValue ("ampduShrinkFactor", "Method 3: factor for decreasing AMPDU size when the latency is above the budget, e.g. 0.618, 0.381, 0.236", ampduShrinkFactor);
 
   // TCP parameters
   cmd.AddValue ("TcpPayloadSize", "Payload size [bytes]", TcpPayloadSize);
@@ -3467,6 +5339,19 @@ int main (int argc, char *argv[]) {
   cmd.AddValue ("outputFileName", "First characters to be used in the name of the output files", outputFileName);
   cmd.AddValue ("outputFileSurname", "Other characters to be used in the name of the output files (not in the average one)", outputFileSurname);
   cmd.AddValue ("saveXMLFile", "Save per-flow results to an XML file?", saveXMLFile);
+  cmd.AddValue ("kpiBufferSize", "Size of the write buffer of each periodic output file (KPIs, AMPDU, positions, flows) [bytes], default 1 MB", kpiBufferSize);
+  cmd.AddValue ("binaryOutput", "Write the KPI, AMPDU and position files in compact columnar binary format ('.col' instead of '.txt'). 'columnar-to-tsv' converts them to text", binaryOutput);
+  cmd.AddValue ("kpiFlushPeriod", "Maximum time [s] without writing the periodic output files to disk. '0' means only when the buffer is full and at the end", kpiFlushPeriod);
+  cmd.AddValue ("replications", "Number of realizations to run in this process, with RngRun, RngRun+1, ... Each one adds '_run-<RngRun>' to the surname", replications);
+  cmd.AddValue ("forkRuns", "Build the scenario once, and then run it in this number of child processes, with RngRun, RngRun+1, ... Each one adds '_fork-<i>' to the surname. What is drawn while building the scenario (e.g. initial positions) is the same in all of them, so they are not independent replications", forkRuns);
+  cmd.AddValue ("forkJobs", "Maximum number of child processes running at the same time with 'forkRuns'. '0' (default) means the number of cores", forkJobs);
+  cmd.AddValue ("asyncOutput", "Format and write the periodic files (KPIs, AMPDU values, positions) and the mobility trace in a separate thread, so the simulation does not wait for them", asynchronousOutput);
+  cmd.AddValue ("resultsFolder", "If set, the results of the run are written to '<resultsFolder>/<outputFileSurname>.res' (a file per run, which 'merge-results' aggregates), instead of adding a line to '_average.txt'", resultsFolder);
+  cmd.AddValue ("resultsPoint", "Point of the sweep of this run (e.g. 'TcpDownUsers-4_method-3'). 'merge-results' aggregates the runs of the same point. By default, the value of outputFileSurname", resultsPoint);
+  cmd.AddValue ("profileCallbacks", "Measure the calls, wall time (total, mean, p99) and allocations of each periodic task and trace sink of this script, and write a table to '_profile.txt' at the end", profileCallbacks);
+  cmd.AddValue ("traceRingSize", "Keep the last N events (associations, AMPDU changes, periodic tasks) in memory. They are written to stderr if the program aborts. '0' (default): no trace", traceRingSize);
+  cmd.AddValue ("traceRingFile", "If set (and traceRingSize > 0), write the last events to this file at the end of the run", traceRingFile);
+  cmd.AddValue ("benchmarkFile", "If set, add a line to this file with the wall time, events per second, simulated seconds per wall second and peak RSS of the run", benchmarkFileName);
 
   // Parameters added in order to allow the manual definition of the scenario
   cmd.AddValue ("defineAPsManually", "Define APs positions, versions and parameters manually", defineAPsManually);
@@ -3478,18 +5363,63 @@ int main (int argc, char *argv[]) {
 
   cmd.Parse (argc, argv);
 
+  // the runs of all the replications belong to the same point of the sweep
+  if (resultsPoint == "")
+    resultsPoint = outputFileSurname;
+
+  // Each replication uses the next value of RngRun
+  if (replication == 0)
+    *firstRun = RngSeedManager::GetRun ();
+  else
+    RngSeedManager::SetRun (*firstRun + replication);
+
+  if (replications > 1) {
+    std::ostringstream runSurname;
+    runSurname << "_run-" << RngSeedManager::GetRun ();
+    outputFileSurname = outputFileSurname + runSurname.str ();
+  }
+
+
+  callbackProfiler.Reset ();
+  callbackProfiler.Enable (profileCallbacks);
+  asyncOutput.Enable (asynchronousOutput);
+
+  // trace of the last events, written if the program aborts
+  traceRing.SetSize (TRACE_RING_COMPILED ? traceRingSize : 0);
+  if (TRACE_RING_COMPILED && (traceRingSize > 0))
+    signal (SIGABRT, TraceRingAbort);
+
+  // The periodic output files are kept open during the simulation. Write them and close them at the end
+  kpiSink.SetParameters (kpiBufferSize, kpiFlushPeriod);
+  Simulator::ScheduleDestroy (&PeriodicTaskList::Clear, &periodicTasks);
+  Simulator::ScheduleDestroy (&Row_sink::Close, &rowSink);  // the last blocks are written before closing the files
+  Simulator::ScheduleDestroy (&KPI_sink::Close, &kpiSink);
+
 
-  // Variable to store the last AMPDU value for which latency was below the limit
-  // I use a pointer because it has to be modified by a function
-  uint32_t *belowLatencyAmpduValue;
-  belowLatencyAmpduValue = (uint32_t *) malloc (1);
-  *belowLatencyAmpduValue = MTU + 100;
+  // The methods for adjusting the AMPDU size
+  RegisterAmpduControllers ();
 
-  // Variable to store the last AMPDU value for which latency was above the limit
-  // I use a pointer because it has to be modified by a function
-  uint32_t *aboveLatencyAmpduValue;
-  aboveLatencyAmpduValue = (uint32_t *) malloc (1);
-  *aboveLatencyAmpduValue = maxAmpduSize;
+  if ( ((aggregationDynamicAlgorithm == 1) || (benchmarkAmpduControllers > 0))
+      && (AmpduControllerRegistry.find (methodAdjustAmpdu) == AmpduControllerRegistry.end ()) ) {
+    std::cout << "AMPDU adjust method unknown\n";
+    exit (1);
+  }
+
+  // Only run the microbenchmark of the AMPDU controllers, and finish
+  if (benchmarkAmpduControllers > 0) {
+    adjustAmpduParameters benchmarkParam;
+    benchmarkParam.verboseLevel = 0;
+    benchmarkParam.timeInterval = timeMonitorKPIs;
+    benchmarkParam.latencyBudget = latencyBudget;
+    benchmarkParam.maxAmpduSize = maxAmpduSize;
+    benchmarkParam.mynameAMPDUFile = "";
+    benchmarkParam.methodAdjustAmpdu = methodAdjustAmpdu;
+    benchmarkParam.stepAdjustAmpdu = stepAdjustAmpdu;
+    benchmarkParam.ampduGrowthFactor = ampduGrowthFactor;
+    benchmarkParam.ampduShrinkFactor = ampduShrinkFactor;
+    BenchmarkAmpduControllers (benchmarkParam, benchmarkAmpduControllers);
+    return 0;
+  }
 
 
   // If these parameters have not been set, set the default values
@@ -3536,6 +5466,16 @@ int main (int argc, char *argv[]) {
 
   BooleanValue error = 0;
 
+  // the children of fork mode cannot share the pcap files, which are opened while building the scenario
+  if ((forkRuns > 1) && (enablePcap)) {
+    std::cout << "INPUT PARAMETER ERROR: 'forkRuns' cannot be used with pcap files. Stopping the simulation." << '\n';
+    error = 1;
+  }
+
+  if ((forkRuns > 1) && (replications > 1)) {
+    std::cout << "INPUT PARAMETER ERROR: 'forkRuns' and 'replications' cannot be used at the same time. Stopping the simulation." << '\n';
+    error = 1;
+  }
 
 
   /********** check input parameters **************/
@@ -3706,17 +5646,13 @@ int main (int argc, char *argv[]) {
   }
 
 
-  // the primary and secondary interfaces CANNOT be in the same band
-  std::string frequencyBandPrimary, frequencyBandSecondary;
-  if ( (version80211primary == "11n5") || (version80211primary == "11ac") || (version80211primary == "11a") )
-    frequencyBandPrimary = "5 GHz"; // 5GHz
-  else
-    frequencyBandPrimary = "2.4 GHz"; // 2.4 GHz
+  // the versions of 802.11, converted once. Wrong versions have been reported above
+  Wifi80211Version versionPrimary = convertNameToVersion (version80211primary);
+  Wifi80211Version versionSecondary = convertNameToVersion (version80211secondary);
 
-  if ( (version80211secondary == "11n5") || (version80211secondary == "11ac") || (version80211secondary == "11a") )
-    frequencyBandSecondary = "5 GHz"; // 5GHz
-  else
-    frequencyBandSecondary = "2.4 GHz"; // 2.4 GHz  
+  // the primary and secondary interfaces CANNOT be in the same band
+  WifiBand frequencyBandPrimary = getWirelessBandOfVersion (versionPrimary);
+  WifiBand frequencyBandSecondary = getWirelessBandOfVersion (versionSecondary);
 
 
   if ((numberAPsSamePlace == 2) || (numberWiFiDevicesInSTAs == 2)) {
@@ -3727,13 +5663,13 @@ int main (int argc, char *argv[]) {
   }
 
   // in the 2.4 GHz band, only 20 MHz channels are supported (by this program so far)
-  if ((frequencyBandPrimary == "2.4 GHz" ) && (channelWidth != 20)) {
+  if ((frequencyBandPrimary == BAND_2_4GHZ ) && (channelWidth != 20)) {
     std::cout << "INPUT PARAMETER ERROR: Only 20 MHz channels can be used (so far) in the 2.4GHz band. Stopping the simulation." << '\n';
     error = 1;  
   }
 
   // in the 2.4 GHz band, only 20 MHz channels are supported (by this program so far)
-  if ((frequencyBandSecondary == "2.4 GHz" ) && (channelWidthSecondary != 20)) {
+  if ((frequencyBandSecondary == BAND_2_4GHZ ) && (channelWidthSecondary != 20)) {
     std::cout << "INPUT PARAMETER ERROR: Only 20 MHz channels can be used (so far) in the 2.4GHz band. Stopping the simulation." << '\n';
     error = 1;  
   }
@@ -3745,7 +5681,7 @@ int main (int argc, char *argv[]) {
   /******** fill the variable with the available channels *************/
   uint8_t availableChannels[numOperationalChannels];
   for (uint32_t i = 0; i < numOperationalChannels; ++i) {
-    if (frequencyBandPrimary == "5 GHz") {
+    if (frequencyBandPrimary == BAND_5GHZ) {
       if (channelWidth == 20)
         availableChannels[i] = availableChannels20MHz[i];
       else if (channelWidth == 40)
@@ -3762,7 +5698,7 @@ int main (int argc, char *argv[]) {
 
   uint8_t availableChannelsSecondary[numOperationalChannels];
   for (uint32_t i = 0; i < numOperationalChannelsSecondary; ++i) {
-    if (frequencyBandSecondary == "5 GHz") {
+    if (frequencyBandSecondary == BAND_5GHZ) {
       if (channelWidthSecondary == 20)
         availableChannelsSecondary[i] = availableChannels20MHz[i];
       else if (channelWidthSecondary == 40)
@@ -3780,7 +5716,7 @@ int main (int argc, char *argv[]) {
 
 
   /************* Show the parameters by the screen *****************/
-  if (verboseLevel > 0) {
+  if (LOG_ENABLED (1, verboseLevel)) {
     LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
     LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
     LogComponentEnable("SimpleMpduAggregation", LOG_LEVEL_INFO);
@@ -3819,6 +5755,8 @@ int main (int argc, char *argv[]) {
     std::cout << "Maximum latency tolerated by VoIP applications: " << latencyBudget << " s" << '\n';
     std::cout << "Method for adjusting AMPDU size: '0' (default), '1' PENDING: " << methodAdjustAmpdu << '\n';
     std::cout << "Step for adjusting AMPDU size: " << stepAdjustAmpdu << " bytes" << '\n';
+    std::cout << "Factor for increasing AMPDU size (method 3): " << ampduGrowthFactor << '\n';
+    std::cout << "Factor for decreasing AMPDU size (method 3): " << ampduShrinkFactor << '\n';
 
     std::cout << '\n';
     // TCP parameters
@@ -3872,80 +5810,6 @@ int main (int argc, char *argv[]) {
   /************* end of - Show the parameters by the screen *****************/
 
 
-  // Variable to store the flowmonitor statistics of the flows during the simulation
-  // VoIP applications generate 1 flow
-  // TCP applications generate 2 flows: 1 for data and 1 for ACKs (statistics are not stored for ACK flows)
-  // video applications generate 1 flow
-  FlowStatistics myFlowStatisticsVoIPUpload[numberVoIPupload];
-  FlowStatistics myFlowStatisticsVoIPDownload[numberVoIPdownload];
-  FlowStatistics myFlowStatisticsTCPUpload[numberTCPupload];
-  FlowStatistics myFlowStatisticsTCPDownload[numberTCPdownload];
-  FlowStatistics myFlowStatisticsVideoDownload[numberVideoDownload];
-
-  AllTheFlowStatistics myAllTheFlowStatistics;
-  myAllTheFlowStatistics.numberVoIPUploadFlows = numberVoIPupload;
-  myAllTheFlowStatistics.numberVoIPDownloadFlows = numberVoIPdownload;
-  myAllTheFlowStatistics.numberTCPUploadFlows = numberTCPupload;
-  myAllTheFlowStatistics.numberTCPDownloadFlows = numberTCPdownload;
-  myAllTheFlowStatistics.numberVideoDownloadFlows = numberVideoDownload;
-  myAllTheFlowStatistics.FlowStatisticsVoIPUpload = myFlowStatisticsVoIPUpload;
-  myAllTheFlowStatistics.FlowStatisticsVoIPDownload = myFlowStatisticsVoIPDownload;
-  myAllTheFlowStatistics.FlowStatisticsTCPUpload = myFlowStatisticsTCPUpload;
-  myAllTheFlowStatistics.FlowStatisticsTCPDownload = myFlowStatisticsTCPDownload;
-  myAllTheFlowStatistics.FlowStatisticsVideoDownload = myFlowStatisticsVideoDownload;
-
-
-  // Initialize to 0
-  for (uint16_t i = 0 ; i < numberVoIPupload; i++) {
-    myFlowStatisticsVoIPUpload[i].acumDelay = 0.0;
-    myFlowStatisticsVoIPUpload[i].acumJitter = 0.0;
-    myFlowStatisticsVoIPUpload[i].acumRxPackets = 0;
-    myFlowStatisticsVoIPUpload[i].acumRxBytes = 0;
-    myFlowStatisticsVoIPUpload[i].acumLostPackets = 0;
-    myFlowStatisticsVoIPUpload[i].destinationPort = INITIALPORT_VOIP_UPLOAD + i;
-  }
-
-  // Initialize to 0
-  for (uint16_t i = 0 ; i < numberVoIPdownload; i++) {
-    myFlowStatisticsVoIPDownload[i].acumDelay = 0.0;
-    myFlowStatisticsVoIPDownload[i].acumJitter = 0.0;
-    myFlowStatisticsVoIPDownload[i].acumRxPackets = 0;
-    myFlowStatisticsVoIPDownload[i].acumRxBytes = 0;
-    myFlowStatisticsVoIPDownload[i].acumLostPackets = 0;
-    myFlowStatisticsVoIPDownload[i].destinationPort = INITIALPORT_VOIP_DOWNLOAD + i;
-  }
-
-  // Initialize to 0
-  for (uint16_t i = 0 ; i < numberTCPupload; i++) {
-    myFlowStatisticsTCPUpload[i].acumDelay = 0.0;
-    myFlowStatisticsTCPUpload[i].acumJitter = 0.0;
-    myFlowStatisticsTCPUpload[i].acumRxPackets = 0;
-    myFlowStatisticsTCPUpload[i].acumRxBytes = 0;
-    myFlowStatisticsTCPUpload[i].acumLostPackets = 0;
-    myFlowStatisticsTCPUpload[i].destinationPort = INITIALPORT_TCP_UPLOAD + i;
-  }
-
-  // Initialize to 0
-  for (uint16_t i = 0 ; i < numberTCPdownload; i++) {
-    myFlowStatisticsTCPDownload[i].acumDelay = 0.0;
-    myFlowStatisticsTCPDownload[i].acumJitter = 0.0;
-    myFlowStatisticsTCPDownload[i].acumRxPackets = 0;
-    myFlowStatisticsTCPDownload[i].acumRxBytes = 0;
-    myFlowStatisticsTCPDownload[i].acumLostPackets = 0;
-    myFlowStatisticsTCPDownload[i].destinationPort = INITIALPORT_TCP_DOWNLOAD + i;
-  }
-
-  // Initialize to 0
-  for (uint16_t i = 0 ; i < numberVideoDownload; i++) {
-    myFlowStatisticsVideoDownload[i].acumDelay = 0.0;
-    myFlowStatisticsVideoDownload[i].acumJitter = 0.0;
-    myFlowStatisticsVideoDownload[i].acumRxPackets = 0;
-    myFlowStatisticsVideoDownload[i].acumRxBytes = 0;
-    myFlowStatisticsVideoDownload[i].acumLostPackets = 0;
-    myFlowStatisticsVideoDownload[i].destinationPort = INITIALPORT_VIDEO_DOWNLOAD + i;
-  }
-
-
   // ARP parameters
   Config::SetDefault ("ns3::ArpCache::AliveTimeout", TimeValue (Seconds (arpAliveTimeout)));
   Config::SetDefault ("ns3::ArpCache::DeadTimeout", TimeValue (Seconds (arpDeadTimeout)));
@@ -4078,7 +5942,7 @@ int main (int argc, char *argv[]) {
   }
 
 
-  if (verboseLevel >= 2) {
+  if (LOG_ENABLED (2, verboseLevel)) {
     for (uint32_t j = 0; j < numberAPsSamePlace; ++j) {
       for (uint32_t i = 0; i < number_of_APs; ++i) {
         //ReportPosition (timeMonitorKPIs, backboneNodes.Get(i), i, 0, 1, apNodes); this would report the position every second
@@ -4163,7 +6027,7 @@ int main (int argc, char *argv[]) {
     auxString << "ns3::UniformRandomVariable[Min=" << x_position_first_AP - distanceToBorder 
               << "|Max=" << ((number_of_APs_per_row -1) * distance_between_APs) + distanceToBorder << "]"; 
     std::string XString = auxString.str();
-    if ( verboseLevel > 1 )
+    if ( LOG_ENABLED (2, verboseLevel) )
       std::cout << "Limits for X: " << XString << '\n';
 
     // clean the string
@@ -4173,7 +6037,7 @@ int main (int argc, char *argv[]) {
     auxString   << "ns3::UniformRandomVariable[Min=" << y_position_first_AP - distanceToBorder 
                 << "|Max=" << ((number_of_APs / number_of_APs_per_row) -1 ) * distance_between_APs + distanceToBorder << "]"; 
     std::string YString = auxString.str();
-    if ( verboseLevel > 1 )
+    if ( LOG_ENABLED (2, verboseLevel) )
       std::cout << "Limits for Y: " << YString << '\n';
 
     // Locate the STAs initially
@@ -4187,7 +6051,7 @@ int main (int argc, char *argv[]) {
     // create a string with the time between speed modifications
     auxString << "5s";
     std::string timeString = auxString.str();
-    if ( verboseLevel > 1 )
+    if ( LOG_ENABLED (2, verboseLevel) )
       std::cout << "The STAs will change their trajectory every " << timeString << '\n';
 
     // clean the string
@@ -4196,7 +6060,7 @@ int main (int argc, char *argv[]) {
     // create a string with the speed
     auxString  << "ns3::ConstantRandomVariable[Constant=" << constantSpeed << "]";
     std::string speedString = auxString.str();
-    if ( verboseLevel > 1 )
+    if ( LOG_ENABLED (2, verboseLevel) )
       std::cout << "Speed with which the STAs move: " << speedString << '\n';
 
     // clean the string
@@ -4208,7 +6072,7 @@ int main (int argc, char *argv[]) {
               << y_position_first_AP - distanceToBorder << "|"
               << ((number_of_APs / number_of_APs_per_row) -1 ) * distance_between_APs + distanceToBorder;
     std::string boundsString = auxString.str();
-    if ( verboseLevel > 1 )
+    if ( LOG_ENABLED (2, verboseLevel) )
       std::cout << "Rectangle where the STAs move: " << boundsString << '\n';
 
     mobility.SetMobilityModel ( "ns3::RandomWalk2dMobilityModel",
@@ -4241,7 +6105,7 @@ int main (int argc, char *argv[]) {
 
     std::string XString = auxString.str();
 
-    if ( verboseLevel > 2 )
+    if ( LOG_ENABLED (3, verboseLevel) )
       std::cout << "Limits for X: " << XString << '\n';
 
     // clean the string
@@ -4254,7 +6118,7 @@ int main (int argc, char *argv[]) {
 
     std::string YString = auxString.str();
 
-    if ( verboseLevel > 2 )
+    if ( LOG_ENABLED (3, verboseLevel) )
       std::cout << "Limits for Y: " << YString << '\n';
 
 
@@ -4270,7 +6134,7 @@ int main (int argc, char *argv[]) {
     // create a string with the speed
     auxString  << "ns3::UniformRandomVariable[Min=0.0|Max=" << constantSpeed << "]";
     std::string speedString = auxString.str();
-    if ( verboseLevel > 2 )
+    if ( LOG_ENABLED (3, verboseLevel) )
       std::cout << "Speed with which the STAs move: " << speedString << '\n';
 
 
@@ -4280,7 +6144,7 @@ int main (int argc, char *argv[]) {
     // create a string with the pause time
     auxString  << "ns3::UniformRandomVariable[Min=0.0|Max=" << pause_time << "]";
     std::string pauseTimeString = auxString.str();
-    if ( verboseLevel > 2 )
+    if ( LOG_ENABLED (3, verboseLevel) )
       std::cout << "The STAs will pause during " << pauseTimeString << '\n';
 
     Ptr<PositionAllocator> taPositionAlloc = pos.Create ()->GetObject<PositionAllocator> ();
@@ -4295,7 +6159,7 @@ int main (int argc, char *argv[]) {
   }
 
 /* 
-  if (verboseLevel > 0)
+  if (LOG_ENABLED (1, verboseLevel))
     for ( j = 0; j < number_of_STAs; ++j) {
       Vector pos = GetPosition (staNodes.Get (j));
       std::cout << "STA#" << number_of_APs + number_of_Servers + j << " Position: " << pos.x << "," << pos.y << '\n';
@@ -4304,16 +6168,11 @@ int main (int argc, char *argv[]) {
 
 
   // Periodically report the positions of all the STAs
-  if ((verboseLevel > 2) && (timeMonitorKPIs > 0)) {
+  if ((LOG_ENABLED (3, verboseLevel)) && (timeMonitorKPIs > 0)) {
     for (uint32_t j = 0; j < number_of_STAs; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL),
-                            &ReportPosition, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            (number_of_APs * numberAPsSamePlace )+ j, 
-                            1, 
-                            verboseLevel, 
-                            apNodes);
+      periodicTasks.Start ( new ReportPositionTask (staNodes.Get(j), (number_of_APs * numberAPsSamePlace )+ j, 1, verboseLevel, apNodes),
+                            INITIALTIMEINTERVAL,
+                            timeMonitorKPIs);
     }
 
     // This makes a callback every time a STA changes its course
@@ -4330,76 +6189,52 @@ int main (int argc, char *argv[]) {
     namePositionsFile << outputFileName
                 << "_"
                 << outputFileSurname
-                << "_positions.txt";
-
-    std::ofstream ofs;
-    ofs.open ( namePositionsFile.str(), std::ofstream::out | std::ofstream::trunc); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
-
-    // write the first line in the file (includes the titles of the columns)
-    ofs << "timestamp [s]\t"
-        << "STA ID\t"
-        << "destinationPort\t"
-        << "STA x [m]\t"
-        << "STA y [m]\t"
-        << "Nearest AP ID\t" 
-        << "AP x [m]\t"
-        << "AP y [m]\t"
-        << "distance STA-nearest AP [m]\t"
-        << "Associated to AP ID\t"
-        << "AP x [m]\t"
-        << "AP y [m]\t"
-        << "distance STA-my AP [m]\t"
-        << "\n";
+                << (binaryOutput ? "_positions.col" : "_positions.txt");
+
+    // the same columns in text and in columnar format. The first line of the text file has the titles of the columns
+    RowWriter* positionsWriter = rowSink.Create (namePositionsFile.str(), binaryOutput);
+    positionsWriter->AddColumn ("timestamp [s]", 'd');
+    positionsWriter->AddColumn ("STA ID", 'u');
+    positionsWriter->AddColumn ("destinationPort", 'u');
+    positionsWriter->AddColumn ("STA x [m]", 'd');
+    positionsWriter->AddColumn ("STA y [m]", 'd');
+    positionsWriter->AddColumn ("Nearest AP ID", 'u');
+    positionsWriter->AddColumn ("AP x [m]", 'd');
+    positionsWriter->AddColumn ("AP y [m]", 'd');
+    positionsWriter->AddColumn ("distance STA-nearest AP [m]", 'd');
+    positionsWriter->AddColumn ("Associated to AP ID", 'u', true);  // blank if the STA is not associated
+    positionsWriter->AddColumn ("AP x [m]", 'd', true);
+    positionsWriter->AddColumn ("AP y [m]", 'd', true);
+    positionsWriter->AddColumn ("distance STA-my AP [m]", 'd', true);
+    positionsWriter->SetTrailingTab ();
+    positionsWriter->WriteHeader ();
+
+    // a single sampler writes the positions of all the STAs
+    PositionSampler* positionSampler = new PositionSampler (apNodes, namePositionsFile.str());
 
     for (uint16_t j = 0; j < numberVoIPupload; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL + timeMonitorKPIs), 
-                            &SavePositionSTA, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            apNodes, 
-                            INITIALPORT_VOIP_UPLOAD + j, 
-                            namePositionsFile.str());
+      positionSampler->AddSTA (staNodes.Get(j), INITIALPORT_VOIP_UPLOAD + j);
     }
 
     for (uint16_t j = numberVoIPupload; j < numberVoIPupload + numberVoIPdownload; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL + timeMonitorKPIs), 
-                            &SavePositionSTA, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            apNodes, 
-                            INITIALPORT_VOIP_DOWNLOAD + j, 
-                            namePositionsFile.str());
+      positionSampler->AddSTA (staNodes.Get(j), INITIALPORT_VOIP_DOWNLOAD + j);
     }
 
     for (uint16_t j = numberVoIPupload + numberVoIPdownload; j < numberVoIPupload + numberVoIPdownload + numberTCPupload; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL + timeMonitorKPIs), 
-                            &SavePositionSTA, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            apNodes, 
-                            INITIALPORT_TCP_UPLOAD + j, 
-                            namePositionsFile.str());
+      positionSampler->AddSTA (staNodes.Get(j), INITIALPORT_TCP_UPLOAD + j);
     }
 
     for (uint16_t j = numberVoIPupload + numberVoIPdownload + numberTCPupload; j < numberVoIPupload + numberVoIPdownload + numberTCPupload + numberTCPdownload; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL + timeMonitorKPIs), 
-                            &SavePositionSTA, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            apNodes, 
-                            INITIALPORT_TCP_DOWNLOAD + j, 
-                            namePositionsFile.str());
+      positionSampler->AddSTA (staNodes.Get(j), INITIALPORT_TCP_DOWNLOAD + j);
     }
 
     for (uint16_t j = numberVoIPupload + numberVoIPdownload + numberTCPupload + numberTCPdownload; j < numberVoIPupload + numberVoIPdownload + numberTCPupload + numberTCPdownload + numberVideoDownload; ++j) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL + timeMonitorKPIs), 
-                            &SavePositionSTA, 
-                            timeMonitorKPIs, 
-                            staNodes.Get(j), 
-                            apNodes, 
-                            INITIALPORT_VIDEO_DOWNLOAD + j, 
-                            namePositionsFile.str());
+      positionSampler->AddSTA (staNodes.Get(j), INITIALPORT_VIDEO_DOWNLOAD + j);
     }
+
+    periodicTasks.Start ( positionSampler,
+                          INITIALTIMEINTERVAL + timeMonitorKPIs,
+                          timeMonitorKPIs);
   }
 
 
@@ -4535,7 +6370,7 @@ int main (int argc, char *argv[]) {
   WifiHelper wifi;
   WifiHelper wifiSecondary; // only used for the secondary WiFi card of each STA
 
-  if ( verboseLevel > 3 )
+  if ( LOG_ENABLED (4, verboseLevel) )
     wifi.EnableLogComponents ();  // Turn on all Wifi logging
 
   // The SetRemoteStationManager method tells the helper the type of rate control algorithm to use.
@@ -4631,8 +6466,7 @@ int main (int argc, char *argv[]) {
     for (uint32_t i = 0 ; i < number_of_APs ; ++i ) {
 
       // Create an empty record per AP
-      AP_record *m_AP_record = new AP_record;
-      AP_vector.push_back(m_AP_record);
+      AP_vector.push_back (AP_record ());
 
       // I use an auxiliary device container and an auxiliary interface container
       NetDeviceContainer apWiFiDev;
@@ -4662,11 +6496,11 @@ int main (int argc, char *argv[]) {
         // define the standard to follow (see https://www.nsnam.org/doxygen/group__wifi.html#ga1299834f4e1c615af3ca738033b76a49)
         if (j == 0) {
           // primary AP
-          wifi.SetStandard (convertVersionToStandard(version80211primary));
+          wifi.SetStandard (convertVersionToStandard(versionPrimary));
         }
         else if (j == 1) {
           // secondary AP
-          wifi.SetStandard (convertVersionToStandard(version80211secondary));
+          wifi.SetStandard (convertVersionToStandard(versionSecondary));
         }
 
         // setup the APs. Modify the maxAmpduSize depending on a random variable
@@ -4744,11 +6578,11 @@ int main (int argc, char *argv[]) {
         // define the standard to follow (see https://www.nsnam.org/doxygen/group__wifi.html#ga1299834f4e1c615af3ca738033b76a49)
         if (j == 0) {
           // primary AP
-          wifi.SetStandard (convertVersionToStandard(version80211primary));
+          wifi.SetStandard (convertVersionToStandard(versionPrimary));
         }
         else if (j == 1) {
           // secondary AP
-          wifi.SetStandard (convertVersionToStandard(version80211secondary));
+          wifi.SetStandard (convertVersionToStandard(versionSecondary));
         }
 
 
@@ -4830,21 +6664,24 @@ int main (int argc, char *argv[]) {
       myaddress = auxString.str();
 
       // update the AP record with the correct value, using the correct version of the function
-      AP_vector[i + j*number_of_APs]->SetApRecord (i + j*number_of_APs, myaddress, my_maxAmpduSize);
+      AP_vector[i + j*number_of_APs].SetApRecord (i + j*number_of_APs, myaddress, my_maxAmpduSize);
+
+      // add the MAC to the index of APs, so the AP can be found from the MAC reported on association
+      Register_AP_Mac (i + j*number_of_APs, Mac48Address::ConvertFrom (apWiFiDev.Get(0)->GetAddress()));
 
       // fill the values of the vector of APs
-      AP_vector[i + j*number_of_APs]->setWirelessChannel(ChannelNoForThisAP);
+      AP_vector[i + j*number_of_APs].setWirelessChannel(ChannelNoForThisAP);
 
 
       // print the IP and the MAC address, and the WiFi channel
-      if (verboseLevel >= 1) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         std::cout << "AP     #" << i + j*number_of_APs << "\tMAC address:  " << apWiFiDev.Get(0)->GetAddress() << '\n';
-        std::cout << "        " << "\tWi-Fi channel: " << uint32_t(AP_vector[i + (j*number_of_APs)]->GetWirelessChannel()) << '\n'; // convert to uint32_t in order to print it
+        std::cout << "        " << "\tWi-Fi channel: " << uint32_t(AP_vector[i + (j*number_of_APs)].GetWirelessChannel()) << '\n'; // convert to uint32_t in order to print it
         std::cout << "\t\tAP with MAC " << myaddress << " added to the list of APs. AMPDU size " << my_maxAmpduSize << " bytes" << '\n';
       }
 
       // also report the position of the AP (defined above)
-      if (verboseLevel >= 1) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         //ReportPosition (timeMonitorKPIs, backboneNodes.Get(i), i, 0, 1, apNodes); this would report the position every second
         //Vector pos = GetPosition (backboneNodes.Get (i));
         Vector pos = GetPosition (apNodes.Get (i + j*number_of_APs));
@@ -4855,12 +6692,29 @@ int main (int argc, char *argv[]) {
       apWiFiDevices.push_back (apWiFiDev);
     }    
   }
+  // the APs do not move: index their positions for nearestAp()
+  BuildAP_spatialIndex (apNodes);
+
   /*************************** end of - Define the APs ******************************/
 
 
   /*************************** Define the STAs ******************************/
   // connect each of the STAs to the wifi channel
 
+  // the settings that are common to all the STAs
+  staSettings.verboseLevel = verboseLevel;
+  staSettings.numOperationalChannels = numOperationalChannels;
+  staSettings.version80211primary = versionPrimary;
+  staSettings.version80211Secondary = versionSecondary;
+  staSettings.bandsSupported = bandsSupportedBySTA(staSettings.numberWiFiCards, versionPrimary, versionSecondary);
+  staSettings.aggregationDisableAlgorithm = aggregationDisableAlgorithm;
+  staSettings.maxAmpduSize = maxAmpduSize;
+  staSettings.maxAmpduSizeWhenAggregationLimited = maxAmpduSizeWhenAggregationLimited;
+  staSettings.wifiModel = wifiModel;
+
+  // the records of the STAs must not move once their callbacks are connected
+  assoc_vector.reserve (number_of_STAs);
+
   // An ssid variable for the STAs
   Ssid stassid; // If you leave it blank, the STAs will send broadcast assoc requests
 
@@ -4997,9 +6851,9 @@ int main (int argc, char *argv[]) {
     // this is the frequency band where the STA can find an AP
     // if it has a single card, only one band can be used
     // if it has two cards, it depends on the band(s) supported by the present AP(s)
-    std::string bandsSupportedByThisSTA;
+    WifiBand bandsSupportedByThisSTA;
 
-    std::string bandsSupportedByAPs = bandsSupportedByTheAPs(numberAPsSamePlace, version80211primary, version80211secondary);
+    WifiBand bandsSupportedByAPs = bandsSupportedByTheAPs(numberAPsSamePlace, versionPrimary, versionSecondary);
 
     // pointer to the nearest AP
     Ptr<Node> myNearestAp, myNearestAp2GHz, myNearestAp5GHz;  
@@ -5010,28 +6864,30 @@ int main (int argc, char *argv[]) {
     if (!defineSTAsManually) {
       // define the STAs automatically
 
-      bandsSupportedByThisSTA = bandsSupportedBySTA(numberWiFiDevicesInSTAs, version80211primary, version80211secondary);
+      bandsSupportedByThisSTA = bandsSupportedBySTA(numberWiFiDevicesInSTAs, versionPrimary, versionSecondary);
       if (VERBOSE_FOR_DEBUG > 0)
         std::cout << "\t\tFrequency band(s) supported by STA#" << staNodes.Get(i)->GetId() 
                   << ": " <<  bandsSupportedByThisSTA 
                   << std::endl;
 
-      if (bandsSupportedByThisSTA == "both") {
+      if (bandsSupportedByThisSTA == BAND_BOTH) {
         // the STAs support both bands (they have 2 wifi devices)
 
-        if (bandsSupportedByAPs == "both") {
+        if (bandsSupportedByAPs == BAND_BOTH) {
           // the APs support both bands, and the STAs support both bands
 
           // look for the nearest AP in the 5GHz band              
-          myNearestAp5GHz = nearestAp (apNodes, staNodes.Get(i), verboseLevel, "5 GHz");
+          myNearestAp5GHz = nearestAp (apNodes, staNodes.Get(i), verboseLevel, BAND_5GHZ);
           // look for the nearest AP in the 2.4GHz band           
-          myNearestAp2GHz = nearestAp (apNodes, staNodes.Get(i), verboseLevel, "2.4 GHz");
+          myNearestAp2GHz = nearestAp (apNodes, staNodes.Get(i), verboseLevel, BAND_2_4GHZ);
 
-          if (getWirelessBandOfStandard(convertVersionToStandard(version80211primary)) == "5GHz") {
+          // this was a comparison with "5GHz", which never matched the "5 GHz" of the band names, so the branch
+          // was never taken. It is kept that way for now, so the results do not change with the enums
+          if (false && (getWirelessBandOfVersion(versionPrimary) == BAND_5GHZ)) {
             // the primary card is in 5GHz and the secondary in 2.4GHz
             myNearestApId = (myNearestAp5GHz)->GetId();
             ChannelNoForThisSTA = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-            if (verboseLevel >= 2)
+            if (LOG_ENABLED (2, verboseLevel))
               std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                         << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                         << " is AP#" <<  myNearestApId 
@@ -5040,7 +6896,7 @@ int main (int argc, char *argv[]) {
 
             myNearestApId = (myNearestAp2GHz)->GetId();
             ChannelNoForThisSTASecondary = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-            if (verboseLevel >= 2)
+            if (LOG_ENABLED (2, verboseLevel))
               std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                         << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                         << " is AP#" <<  myNearestApId 
@@ -5054,7 +6910,7 @@ int main (int argc, char *argv[]) {
               //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
               staDev = wifi.Install (wifiPhy, wifiMacPrimary, staNodes.Get(i));
-              if (verboseLevel >= 2) {
+              if (LOG_ENABLED (2, verboseLevel)) {
                 std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                           << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                           << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5067,7 +6923,7 @@ int main (int argc, char *argv[]) {
                 //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
               
                 staDevSecondary = wifiSecondary.Install (wifiPhy, wifiMacSecondary, staNodes.Get(i));
-                if (verboseLevel >= 2) {
+                if (LOG_ENABLED (2, verboseLevel)) {
                   std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                             << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                             << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5081,7 +6937,7 @@ int main (int argc, char *argv[]) {
               //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
               staDev = wifi.Install (spectrumPhy, wifiMacPrimary, staNodes.Get(i));
-              if (verboseLevel >= 2) {
+              if (LOG_ENABLED (2, verboseLevel)) {
                 std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                           << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                           << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5092,7 +6948,7 @@ int main (int argc, char *argv[]) {
                 spectrumPhy.Set ("ChannelNumber", UintegerValue(ChannelNoForThisSTASecondary));
                 // this installs a second WiFi card in the STA. It will have another MAC address
                 staDevSecondary = wifiSecondary.Install (spectrumPhy, wifiMacSecondary, staNodes.Get (i));
-                if (verboseLevel >= 2) {
+                if (LOG_ENABLED (2, verboseLevel)) {
                   std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                             << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                             << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5105,7 +6961,7 @@ int main (int argc, char *argv[]) {
             // the primary card is in 2.4GHz and the secondary in 5GHz
             myNearestApId = (myNearestAp2GHz)->GetId();
             ChannelNoForThisSTA = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-            if (verboseLevel >= 2)
+            if (LOG_ENABLED (2, verboseLevel))
               std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                         << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                         << " is AP#" <<  myNearestApId 
@@ -5114,7 +6970,7 @@ int main (int argc, char *argv[]) {
 
             myNearestApId = (myNearestAp5GHz)->GetId();
             ChannelNoForThisSTASecondary = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-            if (verboseLevel >= 2)
+            if (LOG_ENABLED (2, verboseLevel))
               std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                         << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                         << " is AP#" <<  myNearestApId 
@@ -5129,7 +6985,7 @@ int main (int argc, char *argv[]) {
               //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
               staDev = wifi.Install (wifiPhy, wifiMacPrimary, staNodes.Get(i));
-              if (verboseLevel >= 2) {
+              if (LOG_ENABLED (2, verboseLevel)) {
                 std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                           << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                           << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5142,7 +6998,7 @@ int main (int argc, char *argv[]) {
                 //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
               
                 staDevSecondary = wifiSecondary.Install (wifiPhy, wifiMacSecondary, staNodes.Get(i));
-                if (verboseLevel >= 2) {
+                if (LOG_ENABLED (2, verboseLevel)) {
                   std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                             << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                             << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5156,7 +7012,7 @@ int main (int argc, char *argv[]) {
               //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
               staDev = wifi.Install (spectrumPhy, wifiMacPrimary, staNodes.Get(i));
-              if (verboseLevel >= 2) {
+              if (LOG_ENABLED (2, verboseLevel)) {
                 std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                           << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                           << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5167,7 +7023,7 @@ int main (int argc, char *argv[]) {
                 spectrumPhy.Set ("ChannelNumber", UintegerValue(ChannelNoForThisSTASecondary));
                 // this installs a second WiFi card in the STA. It will have another MAC address
                 staDevSecondary = wifiSecondary.Install (spectrumPhy, wifiMacSecondary, staNodes.Get (i));
-                if (verboseLevel >= 2) {
+                if (LOG_ENABLED (2, verboseLevel)) {
                   std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                             << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                             << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5183,7 +7039,7 @@ int main (int argc, char *argv[]) {
           myNearestAp = nearestAp (apNodes, staNodes.Get(i), verboseLevel, bandsSupportedByAPs);
           myNearestApId = (myNearestAp)->GetId();
           ChannelNoForThisSTA = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-          if (verboseLevel >= 2)
+          if (LOG_ENABLED (2, verboseLevel))
             std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << " is AP#" <<  myNearestApId 
@@ -5191,13 +7047,15 @@ int main (int argc, char *argv[]) {
                       << '\n';
 
           // the second interface is put in the first channel of the other band
-          if (getWirelessBandOfChannel(ChannelNoForThisSTA) == "2.4GHz") {
+          // this was a comparison with "2.4GHz", which never matched the "2.4 GHz" of the band names, so the
+          // branch was never taken. It is kept that way for now, so the results do not change with the enums
+          if (false && (getWirelessBandOfChannel(ChannelNoForThisSTA) == BAND_2_4GHZ)) {
             ChannelNoForThisSTASecondary = availableChannels20MHz[0];            
           }
           else {
             ChannelNoForThisSTASecondary = availableChannels24GHz20MHz[0];
           }
-          if (verboseLevel >= 2)
+          if (LOG_ENABLED (2, verboseLevel))
             std::cout << "\t\tThere is no AP in the band of STA#" << staNodes.Get(i)->GetId() 
                       << " (" << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                       << ")" 
@@ -5213,7 +7071,7 @@ int main (int argc, char *argv[]) {
           //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
           staDev = wifi.Install (wifiPhy, wifiMacPrimary, staNodes.Get(i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5227,7 +7085,7 @@ int main (int argc, char *argv[]) {
           //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
         
           staDevSecondary = wifiSecondary.Install (wifiPhy, wifiMacSecondary, staNodes.Get(i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                       << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5240,7 +7098,7 @@ int main (int argc, char *argv[]) {
           //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
           staDev = wifi.Install (spectrumPhy, wifiMacPrimary, staNodes.Get(i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled primary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5252,7 +7110,7 @@ int main (int argc, char *argv[]) {
           spectrumPhy.Set ("ChannelNumber", UintegerValue(ChannelNoForThisSTASecondary));
           // this installs a second WiFi card in the STA. It will have another MAC address
           staDevSecondary = wifiSecondary.Install (spectrumPhy, wifiMacSecondary, staNodes.Get (i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled secondary WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTASecondary)
                       << ", in channel " << uint16_t(ChannelNoForThisSTASecondary)
@@ -5263,13 +7121,13 @@ int main (int argc, char *argv[]) {
       else {
         // the STA only supports one band (they have a single wifi device)
 
-        if (bandsSupportedByAPs == "both") {
+        if (bandsSupportedByAPs == BAND_BOTH) {
           // the APs support both bands but the STA supports a single band
           // look for the nearest AP in the band of the STA
           myNearestAp = nearestAp (apNodes, staNodes.Get(i), verboseLevel, bandsSupportedByThisSTA);
           myNearestApId = (myNearestAp)->GetId();
           ChannelNoForThisSTA = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-          if (verboseLevel >= 2)
+          if (LOG_ENABLED (2, verboseLevel))
             std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << " is AP#" <<  myNearestApId 
@@ -5283,7 +7141,7 @@ int main (int argc, char *argv[]) {
             myNearestAp = nearestAp (apNodes, staNodes.Get(i), verboseLevel, bandsSupportedByThisSTA);
             myNearestApId = (myNearestAp)->GetId();
             ChannelNoForThisSTA = GetAP_WirelessChannel (myNearestApId, verboseLevel);
-            if (verboseLevel >= 2)
+            if (LOG_ENABLED (2, verboseLevel))
               std::cout << "\t\tThe nearest AP for STA#" << staNodes.Get(i)->GetId() 
                         << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                         << " is AP#" <<  myNearestApId 
@@ -5306,7 +7164,7 @@ int main (int argc, char *argv[]) {
           //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
           staDev = wifi.Install (wifiPhy, wifiMacPrimary, staNodes.Get(i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled primary (and only) WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5319,7 +7177,7 @@ int main (int argc, char *argv[]) {
           //AP_vector[i]->setWirelessChannel(ChannelNoForThisSTA);
 
           staDev = wifi.Install (spectrumPhy, wifiMacPrimary, staNodes.Get(i));
-          if (verboseLevel >= 2) {
+          if (LOG_ENABLED (2, verboseLevel)) {
             std::cout << "\t\tInstalled primary (and only) WiFi card in STA#" << staNodes.Get(i)->GetId() 
                       << ", in band " << getWirelessBandOfChannel(ChannelNoForThisSTA)
                       << ", in channel " << uint16_t(ChannelNoForThisSTA)
@@ -5380,7 +7238,7 @@ int main (int argc, char *argv[]) {
     }
 
 
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       Ptr<Node> node;
       Ptr<Ipv4> ipv4;
       Ipv4Address addr;
@@ -5412,12 +7270,10 @@ int main (int argc, char *argv[]) {
     }
 
     // Periodically report the channels of all the STAs
-    if ((verboseLevel > 2) && (timeMonitorKPIs > 0)) {
-      Simulator::Schedule ( Seconds (INITIALTIMEINTERVAL),
-                            &ReportChannel, 
-                            timeMonitorKPIs,
-                            ( number_of_APs * numberAPsSamePlace ) + i,
-                            verboseLevel);
+    if ((LOG_ENABLED (3, verboseLevel)) && (timeMonitorKPIs > 0)) {
+      periodicTasks.Start ( new ReportChannelTask (( number_of_APs * numberAPsSamePlace ) + i, verboseLevel),
+                            INITIALTIMEINTERVAL,
+                            timeMonitorKPIs);
     }
 
 
@@ -5432,16 +7288,16 @@ int main (int argc, char *argv[]) {
 
           wifiPhyPtrClient = staDevices[i].Get(0)->GetObject<WifiNetDevice>()->GetPhy()->GetObject<SpectrumWifiPhy>();
 
-          if (verboseLevel > 0)
+          if (LOG_ENABLED (1, verboseLevel))
             std::cout << "STA\t#" << staNodes.Get(i)->GetId()
                       << "\tAdded operational channels: ";
 
           for (uint32_t k = 0; k < numOperationalChannels; k++) {
             //(*wifiPhyPtrClient).AddOperationalChannel ( availableChannels[k] );
-            if (verboseLevel > 0)
+            if (LOG_ENABLED (1, verboseLevel))
               std::cout << uint16_t(availableChannels[k]) << " "; 
           }
-          if (verboseLevel > 0)
+          if (LOG_ENABLED (1, verboseLevel))
             std::cout << '\n';
 
           //myStaWifiMac = staDevices[i].Get(0)->GetObject<WifiNetDevice>()->GetMacOfitsAP()->GetObject<StaWifiMac>();
@@ -5466,7 +7322,7 @@ int main (int argc, char *argv[]) {
 
         //(*wifiPhyPtrClient).ClearOperationalChannelList ();
 
-        if (verboseLevel > 0)
+        if (LOG_ENABLED (1, verboseLevel))
           std::cout << "STA\t#" << staNodes.Get(i)->GetId()
                     << "\tCleared operational channels in STA #" << ( number_of_APs * numberAPsSamePlace ) + i
                     << '\n';
@@ -5478,7 +7334,10 @@ int main (int argc, char *argv[]) {
     //in order to store its association parameters
 
     // This calls the constructor, i.e. the function that creates a record to store the association of each STA
-    STA_record *m_STArecord = new STA_record();
+    // The record is added to the vector of STA associations, in the space reserved for it
+    NS_ASSERT (assoc_vector.size () < assoc_vector.capacity ());
+    assoc_vector.push_back (STA_record ());
+    STA_record *m_STArecord = &assoc_vector.back ();
 
     // Set the value of the id of the STA in the record
     //m_STArecord->setstaid ((*mynode)->GetId());
@@ -5504,18 +7363,6 @@ int main (int argc, char *argv[]) {
 
     }
 
-    // Establish the verbose level in the STA record
-    m_STArecord->SetVerboseLevel (verboseLevel);
-
-    // Establish the rest of the private variables of the STA record
-    m_STArecord->SetnumOperationalChannels (numOperationalChannels);
-    m_STArecord->Setversion80211primary (version80211primary);
-    m_STArecord->Setversion80211Secondary (version80211secondary);
-    m_STArecord->SetaggregationDisableAlgorithm (aggregationDisableAlgorithm);
-    m_STArecord->SetAmpduSize (maxAmpduSize);
-    m_STArecord->SetmaxAmpduSizeWhenAggregationLimited (maxAmpduSizeWhenAggregationLimited);
-    m_STArecord->SetWifiModel (wifiModel);
-
     // Set a callback function to be called each time a STA gets associated to an AP
     std::ostringstream STA;
     //STA << (*mynode)->GetId();
@@ -5536,9 +7383,6 @@ int main (int argc, char *argv[]) {
       Config::Connect ( "/NodeList/"+strSTA+"/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::RegularWifiMac/$ns3::StaWifiMac/DeAssoc", 
                         MakeCallback (&STA_record::UnsetAssoc, m_STArecord));
     //}
-
-    // Add the new record to the vector of STA associations
-    assoc_vector.push_back (m_STArecord);
     /** end of - create a STA_record per STA **/
   }
 
@@ -5753,7 +7597,7 @@ int main (int argc, char *argv[]) {
   }
 
 
-  if (verboseLevel > 0) {
+  if (LOG_ENABLED (1, verboseLevel)) {
     Ptr<Node> node;
     Ptr<Ipv4> ipv4;
     Ipv4Address addr;
@@ -5815,7 +7659,7 @@ int main (int argc, char *argv[]) {
 
 
   // print a blank line after printing IP addresses
-  if (verboseLevel > 0)
+  if (LOG_ENABLED (1, verboseLevel))
     std::cout << "\n";
 
 
@@ -5851,7 +7695,7 @@ int main (int argc, char *argv[]) {
       // Add a route to the network of the servers
       staticRouting->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), addrRouterAPs, 1);
 
-      if (verboseLevel > 0) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         std::cout << "Routing in STA #" << staNodes.Get(i)->GetId() << " with IP address "<< ipv4->GetAddress (1, 0).GetLocal();
         if (numberWiFiDevicesInSTAs==2) {
           std::cout << " and " << ipv4->GetAddress (2, 0).GetLocal();
@@ -5878,7 +7722,7 @@ int main (int argc, char *argv[]) {
       // Add a route to the network of the Stas
       staticRouting->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.0.0"), ipv4Router->GetAddress ( i + 2, 0).GetLocal(), 1);
 
-      if (verboseLevel > 0) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         std::cout << "Routing in server #" << serverNodes.Get(i)->GetId() << " with IP address "<< ipv4->GetAddress (1, 0).GetLocal() << ": ";
         std::cout << "\tadded route to network 10.0.0.0/255.255.0.0 through gateway " << ipv4Router->GetAddress ( i + 2, 0).GetLocal() << '\n';        
       }
@@ -5903,14 +7747,14 @@ int main (int argc, char *argv[]) {
       // Tell the interface to be used for going to this server
       staticRouting->AddHostRouteTo (addrServer, i + 2, 1); // use interface 'i + 2': interface #0 is localhost, and interface #1 is for talking with the APs
 
-      if (verboseLevel > 0) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         std::cout << "Routing in the router (id #" << routerNode.Get(0)->GetId() << "): " ;
         std::cout << "\tadded route to host " << addrServer << " through interface with IP address " << ipv4Router->GetAddress ( i + 2, 0).GetLocal() << '\n';
       }      
     }
 
     // print a blank line after printing routing information
-    if (verboseLevel > 0)
+    if (LOG_ENABLED (1, verboseLevel))
       std::cout << "\n";
   }
 
@@ -5984,7 +7828,7 @@ int main (int argc, char *argv[]) {
     VoipUpClient = myVoipUpClient.Install (staNodes.Get(i));
     VoipUpClient.Start (Seconds (INITIALTIMEINTERVAL));
     VoipUpClient.Stop (Seconds (simulationTime + INITIALTIMEINTERVAL));
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       if (topology == 0) {
         std::cout << "Application VoIP upload   from STA    #" << staNodes.Get(i)->GetId()
                   << "\t with IP address " << staInterfaces[i].GetAddress(0)
@@ -6006,7 +7850,7 @@ int main (int argc, char *argv[]) {
       VoipUpClient = myVoipUpClient.Install (staNodes.Get(i));
       VoipUpClient.Start (Seconds (INITIALTIMEINTERVAL));
       VoipUpClient.Stop (Seconds (simulationTime + INITIALTIMEINTERVAL));
-      if (verboseLevel > 0) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         if (topology == 0) {
           std::cout << "Application VoIP upload   from STA    #" << staNodes.Get(i)->GetId()
                     << "\t with IP address " << staInterfacesSecondary[i].GetAddress(0) << " (secondary)"
@@ -6025,6 +7869,8 @@ int main (int argc, char *argv[]) {
       }
     }*/ 
 
+    flowTable.AddFlow (1, port, staNodes.Get(i)->GetId());  // VoIP upload
+
     port ++; // Each UDP connection requires a different port
   }
 
@@ -6082,7 +7928,7 @@ int main (int argc, char *argv[]) {
     VoipDownClient.Start (Seconds (INITIALTIMEINTERVAL));
     VoipDownClient.Stop (Seconds (simulationTime + INITIALTIMEINTERVAL));
 
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       if (topology == 0) {
         std::cout << "Application VoIP download from the server"
                   << "\t with IP address " << singleServerInterfaces.GetAddress (0) 
@@ -6099,6 +7945,8 @@ int main (int argc, char *argv[]) {
                   << '\n';     
       }     
     }
+    flowTable.AddFlow (2, port, staNodes.Get(i)->GetId());  // VoIP download
+
     port ++;
   }
 
@@ -6140,7 +7988,7 @@ int main (int argc, char *argv[]) {
   }
 
   // Activate the log of BulkSend application
-  if (verboseLevel > 2) {
+  if (LOG_ENABLED (3, verboseLevel)) {
     LogComponentEnable("BulkSendApplication", LOG_LEVEL_INFO);
   }
 
@@ -6191,7 +8039,7 @@ int main (int argc, char *argv[]) {
     // install the application on every staNode
     BulkSendTcpUp = myBulkSendTcpUp.Install (staNodes.Get(i));
 
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       if (topology == 0) {
         std::cout << "Application TCP upload    from STA    #" << staNodes.Get(i)->GetId() 
                   << "\t with IP address " << staInterfaces[i].GetAddress(0) 
@@ -6208,6 +8056,8 @@ int main (int argc, char *argv[]) {
                   << '\n';
       } 
     }
+    flowTable.AddFlow (3, port, staNodes.Get(i)->GetId());  // TCP upload
+
     port++;
   }
   PacketSinkTcpUp.Start (Seconds (0.0));
@@ -6262,7 +8112,7 @@ int main (int argc, char *argv[]) {
       BulkSendTcpDown.Add(myBulkSendTcpDown.Install (serverNodes.Get (i)));
     }
 
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       if (topology == 0) {
         std::cout << "Application TCP download  from the server"
                   << "\t with IP address " << singleServerInterfaces.GetAddress (0) 
@@ -6302,7 +8152,7 @@ int main (int argc, char *argv[]) {
         BulkSendTcpDownSecondary.Add(myBulkSendTcpDownSecondary.Install (serverNodes.Get (i)));
       }
 
-      if (verboseLevel > 0) {
+      if (LOG_ENABLED (1, verboseLevel)) {
         if (topology == 0) {
           std::cout << "Application TCP download  from the server"
                     << "\t with IP address " << singleServerInterfaces.GetAddress (0) 
@@ -6321,6 +8171,8 @@ int main (int argc, char *argv[]) {
       }
     }*/
 
+    flowTable.AddFlow (4, port, staNodes.Get(i)->GetId());  // TCP download
+
     port++;
   }
 
@@ -6379,7 +8231,7 @@ int main (int argc, char *argv[]) {
     Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
     double random_number = x->GetValue(0.0, numberOfMovies * 1.0);
 
-    if ( verboseLevel > 2 )
+    if ( LOG_ENABLED (3, verboseLevel) )
       std::cout << "Random number: " << random_number << "\n\n";
 
     std::string movieFileName;  // The files have to be in the /ns-3-allinone/ns-3-dev/traces folder
@@ -6405,7 +8257,7 @@ int main (int argc, char *argv[]) {
     VideoDownClient.Start (Seconds (INITIALTIMEINTERVAL));
     VideoDownClient.Stop (Seconds (simulationTime + INITIALTIMEINTERVAL));
 
-    if (verboseLevel > 0) {
+    if (LOG_ENABLED (1, verboseLevel)) {
       if (topology == 0) {
         std::cout << "Application Video download from the server"
                   << "\t with IP address " << singleServerInterfaces.GetAddress (0) 
@@ -6424,11 +8276,13 @@ int main (int argc, char *argv[]) {
                   << '\n';     
       }     
     }
+    flowTable.AddFlow (5, port, staNodes.Get(i)->GetId());  // Video download
+
     port ++;
   }
 
   // print a blank line after the info about the applications
-  if (verboseLevel > 0)
+  if (LOG_ENABLED (1, verboseLevel))
     std::cout << "\n";
 
 
@@ -6513,70 +8367,24 @@ int main (int argc, char *argv[]) {
 
   // It is not necessary to monitor the APs, because I am not getting statistics from them
   if (false)
-    monitor = flowmon.Install(apNodes);
+    monitor = flowmon->Install(apNodes);
 
   // install monitor in the STAs
-  monitor = flowmon.Install(staNodes);
+  monitor = flowmon->Install(staNodes);
 
   // install monitor in the server(s)
   if (topology == 0) {
-    monitor = flowmon.Install(singleServerNode);
+    monitor = flowmon->Install(singleServerNode);
   } else {
-    monitor = flowmon.Install(serverNodes);
+    monitor = flowmon->Install(serverNodes);
   }
 
 
   // If the delay monitor is on, periodically calculate the statistics
   if (timeMonitorKPIs > 0.0) {
-    // Schedule a periodic obtaining of statistics    
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL),
-                          &obtainKPIs,
-                          monitor
-                          /*, flowmon*/, // FIXME Avoid the use of a global variable 'flowmon'
-                          myFlowStatisticsVoIPUpload,
-                          1,
-                          verboseLevel,
-                          timeMonitorKPIs);
-
-    // Schedule a periodic obtaining of statistics    
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL),
-                          &obtainKPIs,
-                          monitor
-                          /*, flowmon*/, // FIXME Avoid the use of a global variable 'flowmon'
-                          myFlowStatisticsVoIPDownload,
-                          2,
-                          verboseLevel,
-                          timeMonitorKPIs);
-
-    // Schedule a periodic obtaining of statistics    
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL),
-                          &obtainKPIs,
-                          monitor
-                          /*, flowmon*/, // FIXME Avoid the use of a global variable 'flowmon'
-                          myFlowStatisticsTCPUpload,
-                          3,
-                          verboseLevel,
-                          timeMonitorKPIs);
-
-    // Schedule a periodic obtaining of statistics    
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL),
-                          &obtainKPIs,
-                          monitor
-                          /*, flowmon*/, // FIXME Avoid the use of a global variable 'flowmon'
-                          myFlowStatisticsTCPDownload,
-                          4,
-                          verboseLevel,
-                          timeMonitorKPIs);
-
-    // Schedule a periodic obtaining of statistics    
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL),
-                          &obtainKPIs,
-                          monitor
-                          /*, flowmon*/, // FIXME Avoid the use of a global variable 'flowmon'
-                          myFlowStatisticsVideoDownload,
-                          5,
-                          verboseLevel,
-                          timeMonitorKPIs);
+    // Schedule a periodic obtaining of statistics of all the flows
+    kpiCollector.Setup (monitor, verboseLevel, timeMonitorKPIs);
+    kpiCollector.Start (INITIALTIMEINTERVAL, timeMonitorKPIs);  // it is a global object, not owned by periodicTasks
 
     // Write the values of the network KPIs (delay, etc.) to a file
     // create a string with the name of the output file
@@ -6585,28 +8393,24 @@ int main (int argc, char *argv[]) {
     nameKPIFile << outputFileName
                 << "_"
                 << outputFileSurname
-                << "_KPIs.txt";
-
-    std::ofstream ofs;
-    ofs.open ( nameKPIFile.str(), std::ofstream::out | std::ofstream::trunc); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
-
-    // write the first line in the file (includes the titles of the columns)
-    ofs << "timestamp [s]" << "\t"
-        << "flow ID" << "\t"
-        << "application" << "\t"
-        << "destinationPort" << "\t"
-        << "delay [s]" << "\t"
-        << "jitter [s]" << "\t" 
-        << "numRxPackets" << "\t"
-        << "numlostPackets" << "\t"
-        << "throughput [bps]" << "\n";
+                << (binaryOutput ? "_KPIs.col" : "_KPIs.txt");
+
+    // the same columns in text and in columnar format. The first line of the text file has the titles of the columns
+    RowWriter* kpiWriter = rowSink.Create (nameKPIFile.str(), binaryOutput);
+    kpiWriter->AddColumn ("timestamp [s]", 'd');
+    kpiWriter->AddColumn ("flow ID", 'u');
+    kpiWriter->AddEnumColumn ("application", std::vector<std::string> (KPIapplicationLabels, KPIapplicationLabels + 5));
+    kpiWriter->AddColumn ("destinationPort", 'u');
+    kpiWriter->AddColumn ("delay [s]", 'd');
+    kpiWriter->AddColumn ("jitter [s]", 'd');
+    kpiWriter->AddColumn ("numRxPackets", 'u');
+    kpiWriter->AddColumn ("numlostPackets", 'u');
+    kpiWriter->AddColumn ("throughput [bps]", 'd');
+    kpiWriter->WriteHeader ();
 
     // schedule this after the first time when statistics have been obtained
-    Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL + timeMonitorKPIs + 0.0001),
-                          &saveKPIs,
-                          nameKPIFile.str(),
-                          myAllTheFlowStatistics,
-                          verboseLevel,
+    periodicTasks.Start ( new SaveKPIsTask (nameKPIFile.str(), timeMonitorKPIs),
+                          INITIALTIMEINTERVAL + timeMonitorKPIs + 0.0001,
                           timeMonitorKPIs);
 
     // Algorithm for dynamically adjusting aggregation
@@ -6618,17 +8422,19 @@ int main (int argc, char *argv[]) {
       nameAMPDUFile << outputFileName
                     << "_"
                     << outputFileSurname
-                    << "_AMPDUvalues.txt";
-
-      std::ofstream ofsAMPDU;
-      ofsAMPDU.open ( nameAMPDUFile.str(), std::ofstream::out | std::ofstream::trunc); // with "trunc" Any contents that existed in the file before it is open are discarded. with "app", all output operations happen at the end of the file, appending to its existing contents
-
-      // write the first line in the file (includes the titles of the columns)
-      ofsAMPDU  << "timestamp" << "\t"
-                << "ID" << "\t"
-                << "type" << "\t"
-                << "associated to AP\t"
-                << "AMPDU set to [bytes]" << "\n";
+                    << (binaryOutput ? "_AMPDUvalues.col" : "_AMPDUvalues.txt");
+
+      // the same columns in text and in columnar format. The first line of the text file has the titles of the columns
+      RowWriter* ampduWriter = rowSink.Create (nameAMPDUFile.str(), binaryOutput);
+      ampduWriter->AddColumn ("timestamp", 'd');
+      ampduWriter->AddColumn ("ID", 'u');
+      std::vector<std::string> nodeTypes;
+      nodeTypes.push_back ("AP");
+      nodeTypes.push_back ("STA ");
+      ampduWriter->AddEnumColumn ("type", nodeTypes);
+      ampduWriter->AddColumn ("associated to AP", 'u', true, "-");  // an AP is not associated to any AP
+      ampduWriter->AddColumn ("AMPDU set to [bytes]", 'u');
+      ampduWriter->WriteHeader ();
 
       // prepare the parameters to call the function adjustAMPDU
       adjustAmpduParameters myparam;
@@ -6639,24 +8445,20 @@ int main (int argc, char *argv[]) {
       myparam.mynameAMPDUFile = nameAMPDUFile.str();
       myparam.methodAdjustAmpdu = methodAdjustAmpdu;
       myparam.stepAdjustAmpdu = stepAdjustAmpdu;
+      myparam.ampduGrowthFactor = ampduGrowthFactor;
+      myparam.ampduShrinkFactor = ampduShrinkFactor;
 
-      // Modify the AMPDU of the APs where there are VoIP flows
-      Simulator::Schedule(  Seconds(INITIALTIMEINTERVAL + timeMonitorKPIs + 0.0002),
-                            &adjustAMPDU,
-                            myAllTheFlowStatistics,
-                            myparam,
-                            belowLatencyAmpduValue,
-                            aboveLatencyAmpduValue,
-                            number_of_APs * numberAPsSamePlace);
+      // Modify the AMPDU of the APs where there are VoIP flows, with the controller of the selected method
+      AmpduControllerRegistry[methodAdjustAmpdu].start (myparam,
+                                                        number_of_APs * numberAPsSamePlace,
+                                                        INITIALTIMEINTERVAL + timeMonitorKPIs + 0.0002);
     }
   }
 
 
-  // mobility trace
-  if (writeMobility) {
-    AsciiTraceHelper ascii;
-    MobilityHelper::EnableAsciiAll (ascii.CreateFileStream (outputFileName + "_" + outputFileSurname + "-mobility.txt"));
-  }
+  // mobility trace. In fork mode, each child opens its own file
+  if (writeMobility && (forkRuns <= 1))
+    EnableMobilityTrace (outputFileName + "_" + outputFileSurname + "-mobility.txt");
 
 
 // FIXME ***************Trial: Change the parameters of the AP (disable A-MPDU) during the simulation
@@ -6686,13 +8488,13 @@ int main (int argc, char *argv[]) {
 // FIXME *** end of the trial ***
 
 
-  if ( (verboseLevel > 0) && (aggregationDisableAlgorithm == 1) ) {
+  if ( (LOG_ENABLED (1, verboseLevel)) && (aggregationDisableAlgorithm == 1) ) {
     Simulator::Schedule(Seconds(0.0), &List_STA_record);
     Simulator::Schedule(Seconds(0.0), &ListAPs, verboseLevel);
   }
 
   if (printSeconds > 0) {
-    Simulator::Schedule(Seconds(0.0), &printTime, printSeconds, outputFileName, outputFileSurname);
+    periodicTasks.Start (new PrintTimeTask (outputFileName, outputFileSurname), 0.0, printSeconds);
   }
 
   // Start ARP trial (Failure so far)
@@ -6801,15 +8603,136 @@ if(false) {
 
 
 
-  if (verboseLevel > 0) {
+  if (LOG_ENABLED (1, verboseLevel)) {
     NS_LOG_INFO ("Run Simulation");
     NS_LOG_INFO ("");
   }
 
+  // Find the MACs of the WiFi devices of each node, so ModifyAmpdu does not need Config::Set
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); i++)
+    ResolveAmpduHandles (i);
+  Simulator::ScheduleDestroy (&ClearAmpduHandles);
+
+  // Fork mode: the scenario has been built once. Each child reseeds and runs it
+  if (forkRuns > 1) {
+    // write the titles of the periodic files to disk, so the children can copy them
+    kpiSink.Close ();
+
+    uint32_t maxForkJobs = forkJobs;
+    if (maxForkJobs == 0)
+      maxForkJobs = std::max (1L, sysconf (_SC_NPROCESSORS_ONLN));
+
+    uint32_t running = 0;
+    uint32_t failed = 0;
+    uint32_t forkRun;
+    pid_t child = 1;
+    int status;
+
+    for (forkRun = 0; forkRun < forkRuns; forkRun++) {
+      if (running >= maxForkJobs) {
+        if (wait (&status) > 0) {
+          running--;
+          if (!WIFEXITED (status) || (WEXITSTATUS (status) != 0))
+            failed++;
+        }
+      }
+
+      std::cout.flush ();
+      child = fork ();
+      if (child == 0)
+        break;
+      if (child < 0) {
+        std::cout << "[fork mode] It was not possible to create a child process. Stopping the simulation." << '\n';
+        exit (1);
+      }
+      running++;
+    }
+
+    // the parent only waits for the children
+    if (child != 0) {
+      while (running > 0) {
+        if (wait (&status) <= 0)
+          break;
+        running--;
+        if (!WIFEXITED (status) || (WEXITSTATUS (status) != 0))
+          failed++;
+      }
+
+      // these files only have the titles. Each child has its own copy
+      std::vector<std::string> parentFiles = kpiSink.GetFileNames ();
+      for (uint32_t i = 0; i < parentFiles.size (); i++)
+        std::remove (parentFiles[i].c_str ());
+
+      Simulator::Destroy ();
+
+      if (failed > 0) {
+        std::cout << "[fork mode] " << failed << " of " << forkRuns << " runs failed" << '\n';
+        return 1;
+      }
+      return 0;
+    }
+
+    // child: everything drawn from now on depends on its own RngRun
+    RngSeedManager::SetRun (*firstRun + forkRun);
+
+    // the children are not labelled '_run-<RngRun>' like the replications: they share what was drawn while the
+    // scenario was built (positions, APs with aggregation, movies), so they do not match a run with that RngRun
+    std::ostringstream runSurname;
+    runSurname << "_fork-" << forkRun;
+    kpiSink.Redirect (outputFileName + "_" + outputFileSurname + "_",
+                      outputFileName + "_" + outputFileSurname + runSurname.str () + "_");
+    outputFileSurname = outputFileSurname + runSurname.str ();
+
+    // the random variables already exist, and were seeded with the RngRun of the parent. Create their streams again
+    NodeContainer allNodes = NodeContainer::GetGlobal ();
+    NetDeviceContainer allWifiDevices;
+    for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
+      for (uint32_t k = 0; k < (*i)->GetNDevices (); k++)
+        if (DynamicCast<WifiNetDevice> ((*i)->GetDevice (k)) != 0)
+          allWifiDevices.Add ((*i)->GetDevice (k));
+
+    int64_t stream = 0;
+    stream += wifi.AssignStreams (allWifiDevices, stream);
+    stream += mobility.AssignStreams (allNodes, stream);
+    stream += stack.AssignStreams (allNodes, stream);
+
+    if (writeMobility)
+      EnableMobilityTrace (outputFileName + "_" + outputFileSurname + "-mobility.txt");
+  }
+
   Simulator::Stop (Seconds (simulationTime + INITIALTIMEINTERVAL));
+
+  std::chrono::steady_clock::time_point wallClockRunStart = std::chrono::steady_clock::now ();
+  asyncOutput.Start ();
   Simulator::Run ();
+  asyncOutput.Stop ();  // what the writer thread has pending is written
+  std::chrono::steady_clock::time_point wallClockRunEnd = std::chrono::steady_clock::now ();
+
+  if (benchmarkFileName != "")
+    saveBenchmark ( benchmarkFileName,
+                    outputFileSurname,
+                    std::chrono::duration<double> (wallClockRunStart - wallClockStart).count (),
+                    std::chrono::duration<double> (wallClockRunEnd - wallClockRunStart).count (),
+                    simulationTime + INITIALTIMEINTERVAL);
+
+  if (profileCallbacks) {
+    std::ofstream profileFile ((outputFileName + "_" + outputFileSurname + "_profile.txt").c_str ());
+    callbackProfiler.Write (profileFile, std::chrono::duration<double> (wallClockRunEnd - wallClockRunStart).count ());
+    callbackProfiler.Enable (false);
+  }
+
+  if ((traceRingSize > 0) && (traceRingFile != "")) {
+    FILE* traceFile = fopen (traceRingFile.c_str (), "w");
+    if (traceFile == NULL) {
+      std::cout << "ERROR: cannot open " << traceRingFile << '\n';
+    }
+    else {
+      traceRing.Dump (fileno (traceFile));
+      fclose (traceFile);
+    }
+  }
 
-  if (verboseLevel > 0)
+  if (LOG_ENABLED (1, verboseLevel))
     NS_LOG_INFO ("Simulation finished. Writing results");
 
 
@@ -6822,12 +8745,12 @@ if(false) {
 
   // FlowClassifier provides a method to translate raw packet data into abstract flow identifier and packet identifier parameters
   // see https://www.nsnam.org/doxygen/classns3_1_1_flow_classifier.html
-  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ()); // Returns a pointer to the FlowClassifier object
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon->GetClassifier ()); // Returns a pointer to the FlowClassifier object
 
 
   // Save the results of flowmon to an XML file
   if (saveXMLFile)
-    flowmon.SerializeToXmlFile (outputFileName + "_" + outputFileSurname + "_flowmonitor.xml", true, true);
+    flowmon->SerializeToXmlFile (outputFileName + "_" + outputFileSurname + "_flowmonitor.xml", true, true);
 
 
   // variables used for calculating the averages
@@ -6855,6 +8778,9 @@ if(false) {
 
   double total_video_download_throughput = 0.0; // average throughput of all the download video flows
 
+  // the histograms of all the flows are written at the end, in a single file
+  HistogramStore histograms;
+
   // for each flow
   std::map< FlowId, FlowMonitor::FlowStats > stats = monitor->GetFlowStats(); 
   for (std::map< FlowId, FlowMonitor::FlowStats >::iterator flow=stats.begin(); flow!=stats.end(); flow++) 
@@ -6881,6 +8807,7 @@ if(false) {
 
     // create a string with the characteristics of the flow
     std::ostringstream flowID;
+    std::string application = "";  // empty if the flow is not one of the applications (e.g. the TCP ACKs)
 
     flowID  << flow->first << "\t"      // identifier of the flow (a number)
             << proto << "\t"
@@ -6893,43 +8820,47 @@ if(false) {
     if (  (t.destinationPort >= INITIALPORT_VOIP_UPLOAD ) && 
           (t.destinationPort <  INITIALPORT_VOIP_UPLOAD + numberVoIPupload )) {
       flowID << "\t VoIP upload";
+      application = "VoIP upload";
     // UDP download flows
     } else if ( (t.destinationPort >= INITIALPORT_VOIP_DOWNLOAD ) && 
                 (t.destinationPort <  INITIALPORT_VOIP_DOWNLOAD + numberVoIPdownload )) { 
       flowID << "\t VoIP download";
+      application = "VoIP download";
     // TCP upload flows
     } else if ( (t.destinationPort >= INITIALPORT_TCP_UPLOAD ) && 
                 (t.destinationPort <  INITIALPORT_TCP_UPLOAD + numberTCPupload )) { 
       flowID << "\t TCP upload";
+      application = "TCP upload";
     // TCP download flows
     } else if ( (t.destinationPort >= INITIALPORT_TCP_DOWNLOAD ) && 
                 (t.destinationPort <  INITIALPORT_TCP_DOWNLOAD + numberTCPdownload )) { 
       flowID << "\t TCP download";
+      application = "TCP download";
     } else if ( (t.destinationPort >= INITIALPORT_VIDEO_DOWNLOAD ) && 
                 (t.destinationPort <  INITIALPORT_VIDEO_DOWNLOAD + numberVideoDownload)) { 
       flowID << "\t Video download";
+      application = "Video download";
     } 
 
     // create a string with the name of the output file
-    std::ostringstream nameFlowFile, surnameFlowFile;
+    std::ostringstream nameFlowFile;
 
     nameFlowFile  << outputFileName
                   << "_"
                   << outputFileSurname;
 
-    surnameFlowFile << "_flow_"
-                    << flow->first;
-
     // Print the statistics of this flow to an output file and to the screen
     print_stats ( flow->second, 
                   simulationTime, 
                   generateHistograms, 
                   nameFlowFile.str(), 
-                  surnameFlowFile.str(), 
                   verboseLevel, 
                   flowID.str(), 
                   this_is_the_first_flow );
 
+    if ( generateHistograms > 0 )
+      histograms.Add (flow->first, application, flowID.str(), flow->second);
+
     // the first time, print_stats will print a line with the title of each column
     // put the flag to 0
     if ( this_is_the_first_flow == 1 )
@@ -6981,7 +8912,10 @@ if(false) {
     } 
   }
 
-  if (verboseLevel > 0) {
+  if ( generateHistograms > 0 )
+    histograms.Write (outputFileName + "_" + outputFileSurname + "_histograms.txt");
+
+  if (LOG_ENABLED (1, verboseLevel)) {
     std::cout << "\n" 
               << "The next figures are averaged per packet, not per flow:" << std::endl;
 
@@ -7036,76 +8970,75 @@ if(false) {
               << total_video_download_throughput << "\n";
   }
 
-  // save the average values to a file 
-  std::ofstream ofs;
-  ofs.open ( outputFileName + "_average.txt", std::ofstream::out | std::ofstream::app); // with "app", all output operations happen at the end of the file, appending to its existing contents
-  ofs << outputFileSurname << "\t"
-      << "Number VoIP upload flows" << "\t"
-      << number_of_UDP_upload_flows << "\t";
-  if ( total_VoIP_upload_rx_packets > 0 ) {
-    ofs << "Average VoIP upload latency [s]" << "\t"
-        << total_VoIP_upload_latency / total_VoIP_upload_rx_packets << "\t"
-        << "Average VoIP upload jitter [s]" << "\t"
-        << total_VoIP_upload_jitter / total_VoIP_upload_rx_packets << "\t";
-  } else {
-    ofs << "Average VoIP upload latency [s]" << "\t"
-        << "\t"
-        << "Average VoIP upload jitter [s]" << "\t"
-        << "\t";
-  }
-  if ( total_VoIP_upload_tx_packets > 0 ) {
-    ofs << "Average VoIP upload loss rate" << "\t"
-        << 1.0 - ( double(total_VoIP_upload_rx_packets) / double(total_VoIP_upload_tx_packets) ) << "\t";
-  } else {
-    ofs << "Average VoIP upload loss rate" << "\t"
-        << "\t";
-  }
+  // the average values of this run
+  ResultRecord results;
+  results.Add ("Number VoIP upload flows", number_of_UDP_upload_flows);
+  results.Add ("Average VoIP upload latency [s]", total_VoIP_upload_latency / total_VoIP_upload_rx_packets, total_VoIP_upload_rx_packets > 0);
+  results.Add ("Average VoIP upload jitter [s]", total_VoIP_upload_jitter / total_VoIP_upload_rx_packets, total_VoIP_upload_rx_packets > 0);
+  results.Add ("Average VoIP upload loss rate", 1.0 - ( double(total_VoIP_upload_rx_packets) / double(total_VoIP_upload_tx_packets) ), total_VoIP_upload_tx_packets > 0);
+  results.Add ("Number VoIP download flows", number_of_UDP_download_flows);
+  results.Add ("Average VoIP download latency [s]", total_VoIP_download_latency / total_VoIP_download_rx_packets, total_VoIP_download_rx_packets > 0);
+  results.Add ("Average VoIP download jitter [s]", total_VoIP_download_jitter / total_VoIP_download_rx_packets, total_VoIP_download_rx_packets > 0);
+  results.Add ("Average VoIP download loss rate", 1.0 - ( double(total_VoIP_download_rx_packets) / double(total_VoIP_download_tx_packets) ), total_VoIP_download_tx_packets > 0);
+  results.Add ("Number TCP upload flows", number_of_TCP_upload_flows);
+  results.Add ("Total TCP upload throughput [bps]", total_TCP_upload_throughput);
+  results.Add ("Number TCP download flows", number_of_TCP_download_flows);
+  results.Add ("Total TCP download throughput [bps]", total_TCP_download_throughput);
+  results.Add ("Number video download flows", number_of_video_download_flows);
+  results.Add ("Total video download throughput [bps]", total_video_download_throughput);
+  results.Add ("Duration of the simulation [s]", simulationTime);
+
+  // save them to a file: a record in its own file (a shard), or a line added at the end of '_average.txt'
+  if (resultsFolder != "")
+    results.WriteShard (resultsFolder, outputFileSurname, resultsPoint, RngSeedManager::GetRun ());
+  else
+    results.AppendLine (outputFileName + "_average.txt", outputFileSurname);
 
-  ofs << "Number VoIP download flows" << "\t"
-      << number_of_UDP_download_flows << "\t";
-  if ( total_VoIP_download_rx_packets > 0 ) {
-    ofs << "Average VoIP download latency [s]" << "\t"
-        << total_VoIP_download_latency / total_VoIP_download_rx_packets << "\t"
-        << "Average VoIP download jitter [s]" << "\t"
-        << total_VoIP_download_jitter / total_VoIP_download_rx_packets << "\t";
-  } else {
-    ofs << "Average VoIP download latency [s]" << "\t"
-        << "\t"
-        << "Average VoIP download jitter [s]" << "\t"
-        << "\t";
-  }
-  if ( total_VoIP_download_tx_packets > 0 ) {
-    ofs << "Average VoIP download loss rate" << "\t"
-        << 1.0 - ( double(total_VoIP_download_rx_packets) / double(total_VoIP_download_tx_packets) ) << "\t";
-  } else {
-    ofs << "Average VoIP download loss rate" << "\t"
-        << "\t";
-  }
+  // Cleanup
+  Simulator::Destroy ();
+  if (LOG_ENABLED (1, verboseLevel))
+    NS_LOG_INFO ("Done");
 
-  ofs << "Number TCP upload flows" << "\t"
-      << number_of_TCP_upload_flows << "\t"
-      << "Total TCP upload throughput [bps]" << "\t"
-      << total_TCP_upload_throughput << "\t"
+  *numberReplications = replications;
+  return 0;
+}
 
-      << "Number TCP download flows" << "\t"
-      << number_of_TCP_download_flows << "\t"
-      << "Total TCP download throughput [bps]" << "\t"
-      << total_TCP_download_throughput << "\t";
 
-  ofs << "Number video download flows" << "\t"
-      << number_of_video_download_flows << "\t"
-      << "Total video download throughput [bps]" << "\t"
-      << total_video_download_throughput << "\t";
+// Leave the global variables as they were at the beginning, so another replication can be run
+// It is called after Simulator::Destroy, so no event can use the records any more
+static void
+resetGlobalState ()
+{
+  AP_vector.clear ();
+  AP_macIndex.clear ();
 
-  ofs << "Duration of the simulation [s]" << "\t"
-      << simulationTime << "\n";
+  assoc_vector.clear ();
+  AP_membersVector.clear ();
+  staSettings = STA_settings ();
 
-  ofs.close();
+  AP_grid2_4GHz = AP_spatialGrid ();
+  AP_grid5GHz = AP_spatialGrid ();
+  AP_gridBothBands = AP_spatialGrid ();
+
+  kpiCollector = KPI_collector ();
+  flowTable.Clear ();
+
+  delete flowmon;
+  flowmon = NULL;
+}
 
-  // Cleanup
-  Simulator::Destroy ();
-  if (verboseLevel > 0)
-    NS_LOG_INFO ("Done");
 
+int main (int argc, char *argv[]) {
+
+  // by default, a single replication. The value of '--replications' is known when the first one finishes
+  uint32_t numberReplications = 1;
+  uint64_t firstRun = 0;
+
+  for (uint32_t replication = 0; replication < numberReplications; replication++) {
+    int result = runReplication (argc, argv, replication, &numberReplications, &firstRun);
+    resetGlobalState ();
+    if (result != 0)
+      return result;
+  }
   return 0;
 }
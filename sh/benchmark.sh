@@ -0,0 +1,143 @@
+#!/bin/bash
+
+# Benchmark of the speed of the simulator. It runs a fixed set of scenarios, one after
+# the other (never in parallel, so they do not compete for the CPU), and each run adds
+# a line to $BENCHMARK_FILE with:
+#   scenario, setup wall time, run wall time, events, events per second,
+#   simulated seconds per wall second, peak RSS
+#
+# Compare the file of two versions of the .cc to see if a change has made the simulator slower.
+#
+# Any of the variables below can be overridden from the environment, e.g.
+#   SIMULATION_TIME=20 BENCHMARK_FILE=before.txt ./benchmark.sh
+
+INIT_FILE_NAME=${INIT_FILE_NAME:-"benchmark"}
+
+# name of the .cc file in the scratch folder
+SCRIPT_NAME=${SCRIPT_NAME:-"wifi-central-controlled-aggregation_v215"}
+
+# the results. If it exists, the lines are added at the end
+BENCHMARK_FILE=${BENCHMARK_FILE:-${INIT_FILE_NAME}"_results.txt"}
+
+SIMULATION_TIME=${SIMULATION_TIME:-10}
+SEED=${SEED:-1}
+
+# only run the scenarios whose name contains this string (e.g. "grid16_topology2")
+FILTER=${FILTER:-""}
+
+# waf builds scratch programs as build/scratch/ns3.<version>-<name>-<profile>
+if [ -z "$BINARY" ]; then
+  BINARY=$(ls build/scratch/ns3*-${SCRIPT_NAME}-optimized 2>/dev/null | head -n 1)
+fi
+
+RUNS_FOLDER=${INIT_FILE_NAME}"_runs"
+
+
+# build before measuring anything
+if [ "$SKIP_BUILD" != "1" ]; then
+  ./waf build || exit 1
+  if [ -z "$BINARY" ]; then
+    BINARY=$(ls build/scratch/ns3*-${SCRIPT_NAME}-optimized 2>/dev/null | head -n 1)
+  fi
+fi
+
+if [ -z "$BINARY" ] || [ ! -x "$BINARY" ]; then
+  echo "Executable of $SCRIPT_NAME not found. Run './waf configure -d optimized' and './waf build' first, or set BINARY"
+  exit 1
+fi
+
+# the binary needs the ns3 libraries, which are not installed system-wide
+export LD_LIBRARY_PATH=$(pwd)/build/lib:$LD_LIBRARY_PATH
+
+mkdir -p $RUNS_FOLDER
+
+# scenarios that did not finish. If there is any, the script exits with an error at the end
+FAILED_SCENARIOS=""
+
+
+# parameters common to all the scenarios
+COMMON_PARAMETERS="--simulationTime=$SIMULATION_TIME \
+  --numberVoIPdownload=0 \
+  --numberTCPupload=0 \
+  --numberVideoDownload=0 \
+  --nodeMobility=2 \
+  --constantSpeed=1 \
+  --arpAliveTimeout=1.0 \
+  --rateModel=Ideal \
+  --enablePcap=0 \
+  --generateHistograms=0 \
+  --writeMobility=0 \
+  --numOperationalChannels=16 \
+  --numOperationalChannelsSecondary=16 \
+  --verboseLevel=0 \
+  --printSeconds=0 \
+  --channelWidth=20 \
+  --channelWidthSecondary=20 \
+  --errorRateModel=0 \
+  --propagationLossModel=2 \
+  --powerLevel=-3 \
+  --prioritiesEnabled=0 \
+  --RtsCtsThreshold=0 \
+  --defineAPsManually=0 \
+  --defineSTAsManually=0 \
+  --numberAPsSamePlace=1 \
+  --numberWiFiDevicesInSTAs=1 \
+  --version80211primary=11ac \
+  --version80211secondary=11n2.4 \
+  --rateAPsWithAMPDUenabled=1.0 --aggregationDisableAlgorithm=0 \
+  --aggregationDynamicAlgorithm=1 --timeMonitorKPIs=0.25 --latencyBudget=0.004 \
+  --methodAdjustAmpdu=3 --stepAdjustAmpdu=3000"
+
+
+# run a scenario. Arguments: name, parameters of the scenario
+run_scenario () {
+  NAME=$1
+  shift
+
+  if [ -n "$FILTER" ] && [[ "$NAME" != *"$FILTER"* ]]; then
+    return
+  fi
+
+  RUN_FOLDER=$RUNS_FOLDER/$NAME
+  rm -rf $RUN_FOLDER
+  mkdir -p $RUN_FOLDER
+
+  echo "$INIT_FILE_NAME $(date) $NAME. Starting..."
+
+  NS_GLOBAL_VALUE="RngRun=$SEED" $BINARY $COMMON_PARAMETERS "$@" \
+    --outputFileName=$RUN_FOLDER/$INIT_FILE_NAME \
+    --outputFileSurname=$NAME \
+    --benchmarkFile=$BENCHMARK_FILE > $RUN_FOLDER/log.txt 2>&1
+
+  if [ $? -ne 0 ]; then
+    echo "$INIT_FILE_NAME $(date) $NAME FAILED. See $RUN_FOLDER/log.txt"
+    FAILED_SCENARIOS="$FAILED_SCENARIOS $NAME"
+  fi
+}
+
+
+# 1 AP, 1 STA
+run_scenario "1ap1sta" \
+  --numberVoIPupload=1 --numberTCPdownload=0 \
+  --number_of_APs=1 --number_of_APs_per_row=1 --distance_between_APs=50 \
+  --topology=2 --wifiModel=1
+
+# 16 APs in a grid, 20 TCP download users and 20 VoIP upload users,
+# with the three topologies and the two WiFi models (0 Yans, 1 Spectrum)
+for topology in 0 1 2; do
+  for wifiModel in 0 1; do
+    run_scenario "grid16_topology"$topology"_wifiModel"$wifiModel \
+      --numberVoIPupload=20 --numberTCPdownload=20 \
+      --number_of_APs=16 --number_of_APs_per_row=4 --distance_between_APs=50 \
+      --topology=$topology --wifiModel=$wifiModel
+  done
+done
+
+echo "$INIT_FILE_NAME $(date) finished. Results in $BENCHMARK_FILE"
+cat $BENCHMARK_FILE
+
+# a crash or a regression must not go unnoticed: the results file simply has no line for those scenarios
+if [ -n "$FAILED_SCENARIOS" ]; then
+  echo "$INIT_FILE_NAME $(date) these scenarios FAILED:$FAILED_SCENARIOS"
+  exit 1
+fi
@@ -0,0 +1,466 @@
+#!/bin/bash
+
+# Parallel sweep runner. It runs the same grid as the testXXX.sh scripts
+# (number of users x seeds x AMPDU adjustment method x factors of method 3), but it calls the
+# prebuilt binary directly, with one job per core.
+#
+# Each run writes into its own folder (<INIT_FILE_NAME>_runs/<surname>/), so
+# the '_average.txt' appends of concurrent runs never interleave. When all the
+# runs have finished, their rows are concatenated in grid order into
+# <INIT_FILE_NAME>_average.txt, with the same format as the serial scripts.
+#
+# If the binary has the option '--resultsFolder' (v215) and merge-results is available, each run writes
+# instead its results to a file of its own (a shard) in <INIT_FILE_NAME>_results/, and merge-results
+# reads them: <INIT_FILE_NAME>_average.txt is rebuilt from the shards (one row per run, ordered by
+# surname), and <INIT_FILE_NAME>_summary.txt has the mean and the confidence interval of each point.
+#
+# The results of the finished runs are kept in a cache ($CACHE_FOLDER), with a key obtained from the
+# binary, the ns3 libraries, all the parameters of the run and the seed. If a run of the grid has
+# the same key as one in the cache, it is not simulated again: its '_average' and '_flows' files are
+# taken from the cache. So, if an option is changed, only the runs affected by it are simulated.
+# CACHE=0 runs everything again (the cache is not read, but it is updated).
+#
+# With SEQUENTIAL=1, the number of seeds of each point of the grid is not fixed: each point starts with
+# MINSEEDS seeds, and SEED_BATCH seeds more are added while the 95% confidence interval of any of the
+# TARGET_METRICS (columns of '_average.txt') is wider than TOLERANCE times its mean, up to MAXSEED.
+# So the noisy points get more seeds than the stable ones. The seeds used by each point and the
+# confidence intervals are written to <INIT_FILE_NAME>_seeds.txt.
+#
+# Any of the variables below can be overridden from the environment, e.g.
+#   JOBS=32 METHODS="0 3" MAXSEED=5 ./sweep.sh
+
+INIT_FILE_NAME=${INIT_FILE_NAME:-"sweep"}
+
+# name of the .cc file in the scratch folder
+SCRIPT_NAME=${SCRIPT_NAME:-"wifi-central-controlled-aggregation_v199"}
+
+# grid of the sweep
+NUM_TCP_USERS_LIST=${NUM_TCP_USERS_LIST:-"4 8 12 16 20"}
+PERCENTAGE_VOIP_USERS=${PERCENTAGE_VOIP_USERS:-100} #10 means 10%, i.e. there will be a VoIP upload user per each 10 TCP download users
+METHODS=${METHODS:-"3"}
+INITSEED=${INITSEED:-1}
+MAXSEED=${MAXSEED:-15}
+
+# factors of method 3, as "growth:shrink" pairs, e.g. "1.618:0.618 2.618:0.381"
+# If empty, the factors are not passed and the defaults of the .cc file are used
+AMPDU_FACTORS=${AMPDU_FACTORS:-""}
+
+# extra parameters added to every run (e.g. "--maxAmpduSize=8000")
+EXTRA_PARAMETERS=${EXTRA_PARAMETERS:-""}
+
+# number of simultaneous runs. By default, one per core
+JOBS=${JOBS:-$(nproc)}
+
+# sequential stopping (see above). INITSEED is the first seed, and MAXSEED the last one that can be used
+SEQUENTIAL=${SEQUENTIAL:-0}
+MINSEEDS=${MINSEEDS:-3}
+SEED_BATCH=${SEED_BATCH:-2}
+TOLERANCE=${TOLERANCE:-0.05} # half-width of the confidence interval, relative to the mean
+TARGET_METRICS=${TARGET_METRICS:-"Average VoIP upload latency [s]|Total TCP download throughput [bps]"} # separated by '|'
+
+# cache of the results of the finished runs. It can be shared by several sweeps
+CACHE=${CACHE:-1}
+CACHE_FOLDER=${CACHE_FOLDER:-"sweep_cache"}
+
+# the tool that merges the shards. If it does not exist, it is compiled from MERGE_RESULTS_SOURCE
+MERGE_RESULTS=${MERGE_RESULTS:-"./merge-results"}
+MERGE_RESULTS_SOURCE=${MERGE_RESULTS_SOURCE:-"scratch/merge-results.cc"}
+
+# waf builds scratch programs as build/scratch/ns3.<version>-<name>-<profile>
+if [ -z "$BINARY" ]; then
+  BINARY=$(ls build/scratch/ns3*-${SCRIPT_NAME}-optimized 2>/dev/null | head -n 1)
+fi
+
+RUNS_FOLDER=${INIT_FILE_NAME}"_runs"
+RESULTS_FOLDER=${INIT_FILE_NAME}"_results"
+
+
+# build once, before launching the pool (waf must not be run concurrently)
+if [ "$SKIP_BUILD" != "1" ]; then
+  ./waf build || exit 1
+  if [ -z "$BINARY" ]; then
+    BINARY=$(ls build/scratch/ns3*-${SCRIPT_NAME}-optimized 2>/dev/null | head -n 1)
+  fi
+fi
+
+if [ -z "$BINARY" ] || [ ! -x "$BINARY" ]; then
+  echo "Executable of $SCRIPT_NAME not found. Run './waf configure -d optimized' and './waf build' first, or set BINARY"
+  exit 1
+fi
+
+# the binary needs the ns3 libraries, which are not installed system-wide
+export LD_LIBRARY_PATH=$(pwd)/build/lib:$LD_LIBRARY_PATH
+
+mkdir -p $RUNS_FOLDER
+mkdir -p $CACHE_FOLDER
+
+# version of the simulator: the binary and the ns3 libraries it uses
+BINARY_HASH=$(cat $BINARY build/lib/libns3*.so 2>/dev/null | sha256sum | cut -d' ' -f1)
+
+# shards: only if the binary can write them and they can be merged. Otherwise, the '_average.txt' rows are used
+SHARDS=0
+if $BINARY --PrintHelp 2>&1 | grep -q -- "--resultsFolder"; then
+  if [ ! -x "$MERGE_RESULTS" ] && [ -f "$MERGE_RESULTS_SOURCE" ]; then
+    MERGE_RESULTS=$RUNS_FOLDER/merge-results
+    g++ -O2 -pthread -o $MERGE_RESULTS $MERGE_RESULTS_SOURCE
+  fi
+  if [ -x "$MERGE_RESULTS" ]; then
+    SHARDS=1
+    # the shards of a previous sweep must not be merged with these ones
+    rm -rf $RESULTS_FOLDER
+    mkdir -p $RESULTS_FOLDER
+  else
+    echo "$INIT_FILE_NAME $(date) merge-results not found ($MERGE_RESULTS). The rows of '_average.txt' are used instead of shards"
+  fi
+fi
+
+
+# a single point with the default factors
+if [ -z "$AMPDU_FACTORS" ]; then
+  FACTORS_LIST="-"
+else
+  FACTORS_LIST=$AMPDU_FACTORS
+fi
+
+# name of a run. Arguments: number of TCP users, method, factors, seed
+surname_of () {
+  if [ "$3" = "-" ]; then
+    echo "TcpDownUsers-"$1"_method-"$2"_seed-"$4
+  else
+    echo "TcpDownUsers-"$1"_method-"$2"_factors-"${3%:*}"-"${3#*:}"_seed-"$4
+  fi
+}
+
+
+# file with the results of a run in the cache: its shard, or its row of '_average.txt'
+if [ "$SHARDS" = "1" ]; then
+  CACHED_RESULTS="result.res"
+else
+  CACHED_RESULTS="average.txt"
+fi
+
+# store the results of a finished run in the cache. Arguments: folder of the run, surname, folder in the cache
+# The files are copied to a temporary folder, which is renamed at the end, so a run that is
+# interrupted never leaves an incomplete entry
+add_to_cache () {
+  if [ "$SHARDS" = "1" ]; then
+    RESULTS=$RESULTS_FOLDER/$2.res
+  else
+    RESULTS=$1/${INIT_FILE_NAME}_average.txt
+  fi
+  if [ ! -f $RESULTS ]; then
+    return
+  fi
+  TEMPORARY=$(mktemp -d $CACHE_FOLDER/tmp.XXXXXX)
+  cp $RESULTS $TEMPORARY/$CACHED_RESULTS
+  if [ -f $1/${INIT_FILE_NAME}_$2_flows.txt ]; then
+    cp $1/${INIT_FILE_NAME}_$2_flows.txt $TEMPORARY/flows.txt
+  fi
+  rm -rf $3
+  mv $TEMPORARY $3 2>/dev/null || rm -rf $TEMPORARY
+}
+
+
+# run a single simulation. Arguments: number of TCP users, method, factors, seed
+run_one () {
+  NUMBER_TCP_USERS=$1
+  METHOD=$2
+  FACTORS=$3
+  seed=$4
+
+  NUMBER_VOIP_USERS=$(( (${NUMBER_TCP_USERS}*${PERCENTAGE_VOIP_USERS}) / 100))
+
+  FACTORS_PARAMETERS=""
+  if [ "$FACTORS" != "-" ]; then
+    FACTORS_PARAMETERS="--ampduGrowthFactor=${FACTORS%:*} --ampduShrinkFactor=${FACTORS#*:}"
+  fi
+
+  SURNAME=$(surname_of $NUMBER_TCP_USERS $METHOD $FACTORS $seed)
+  RUN_FOLDER=$RUNS_FOLDER/$SURNAME
+
+  # a previous sweep may have left results here
+  rm -rf $RUN_FOLDER
+  mkdir -p $RUN_FOLDER
+
+  # the shard and the point of the sweep (the surname without the seed) do not change the results,
+  # so they are not part of the key of the cache
+  RESULTS_PARAMETERS=""
+  if [ "$SHARDS" = "1" ]; then
+    rm -f $RESULTS_FOLDER/$SURNAME.res
+    RESULTS_PARAMETERS="--resultsFolder=$RESULTS_FOLDER --resultsPoint=${SURNAME%_seed-*}"
+  fi
+
+  # parameters of the executable, except the name of the output files, which does not change the results
+  parameters_string=" --simulationTime=60 \
+    --numberVoIPupload=$NUMBER_VOIP_USERS \
+    --numberVoIPdownload=0 \
+    --numberTCPupload=0 \
+    --numberTCPdownload=$NUMBER_TCP_USERS \
+    --numberVideoDownload=0 \
+    --nodeMobility=2 \
+    --constantSpeed=1 \
+    --number_of_APs=16 \
+    --number_of_APs_per_row=4 \
+    --distance_between_APs=50 \
+    --arpAliveTimeout=1.0 \
+    --outputFileSurname=$SURNAME \
+    --rateModel=Ideal \
+    --enablePcap=0 \
+    --generateHistograms=0 \
+    --writeMobility=1 \
+    --numChannels=16 \
+    --verboseLevel=0 \
+    --printSeconds=10 \
+    --version80211=1 \
+    --channelWidth=20 \
+    --wifiModel=1 \
+    --errorRateModel=0 \
+    --propagationLossModel=2 \
+    --topology=2 \
+    --powerLevel=-3 \
+    --prioritiesEnabled=0 \
+    --RtsCtsThreshold=0 \
+    --rateAPsWithAMPDUenabled=1.0 --aggregationDisableAlgorithm=0 \
+    --aggregationDynamicAlgorithm=1 --timeMonitorKPIs=0.25 --latencyBudget=0.004 \
+    --methodAdjustAmpdu=$METHOD --stepAdjustAmpdu=3000 \
+    $FACTORS_PARAMETERS \
+    $EXTRA_PARAMETERS"
+
+  # key of the run in the cache. The parameters are split into words, so the spaces do not matter
+  KEY=$(echo $BINARY_HASH $seed $parameters_string | sha256sum | cut -d' ' -f1)
+  CACHED=$CACHE_FOLDER/$KEY
+
+  if [ "$CACHE" = "1" ] && [ -f $CACHED/$CACHED_RESULTS ]; then
+    if [ "$SHARDS" = "1" ]; then
+      cp $CACHED/result.res $RESULTS_FOLDER/$SURNAME.res
+    else
+      cp $CACHED/average.txt $RUN_FOLDER/${INIT_FILE_NAME}_average.txt
+    fi
+    if [ -f $CACHED/flows.txt ]; then
+      cp $CACHED/flows.txt $RUN_FOLDER/${INIT_FILE_NAME}_${SURNAME}_flows.txt
+    fi
+    echo "$INIT_FILE_NAME $(date) $SURNAME taken from the cache ($KEY)"
+    return
+  fi
+
+  echo "$INIT_FILE_NAME $(date) seed: $seed. method $METHOD. factors $FACTORS. number of TCP download users $NUMBER_TCP_USERS. number VoIP upload users $NUMBER_VOIP_USERS. Starting..."
+
+  NS_GLOBAL_VALUE="RngRun=$seed" $BINARY --outputFileName=$RUN_FOLDER/$INIT_FILE_NAME $RESULTS_PARAMETERS $parameters_string > $RUN_FOLDER/log.txt 2>&1
+
+  if [ $? -ne 0 ]; then
+    echo "$INIT_FILE_NAME $(date) $SURNAME FAILED. See $RUN_FOLDER/log.txt"
+  else
+    echo "$INIT_FILE_NAME $(date) $SURNAME finished"
+    add_to_cache $RUN_FOLDER $SURNAME $CACHED
+  fi
+}
+
+
+# launch the runs of a point of the grid, keeping at most $JOBS runs alive.
+# Arguments: number of TCP users, method, factors, first seed, last seed
+launch_runs () {
+  for ((seed=$4; seed<=$5; seed++)); do
+
+    while [ $(jobs -rp | wc -l) -ge $JOBS ]; do
+      wait -n
+    done
+
+    run_one $1 $2 $3 $seed &
+  done
+}
+
+
+# rows of '_average.txt' of the seeds of a point. Arguments: number of TCP users, method, factors, last seed
+rows_of () {
+  for ((seed=INITSEED; seed<=$4; seed++)); do
+    SURNAME=$(surname_of $1 $2 $3 $seed)
+    if [ -f $RUNS_FOLDER/$SURNAME/${INIT_FILE_NAME}_average.txt ]; then
+      cat $RUNS_FOLDER/$SURNAME/${INIT_FILE_NAME}_average.txt
+    fi
+  done
+}
+
+
+# shards of the seeds of a point. Arguments: number of TCP users, method, factors, last seed
+shards_of () {
+  for ((seed=INITSEED; seed<=$4; seed++)); do
+    SURNAME=$(surname_of $1 $2 $3 $seed)
+    if [ -f $RESULTS_FOLDER/$SURNAME.res ]; then
+      echo $RESULTS_FOLDER/$SURNAME.res
+    fi
+  done
+}
+
+
+# confidence intervals of the TARGET_METRICS of a point, with the same output as confidence_intervals,
+# from what merge-results writes for its shards (read from stdin: point, metric, n, mean, stddev, ci95)
+merged_confidence_intervals () {
+  awk -F'\t' -v metrics="$TARGET_METRICS" -v tolerance=$TOLERANCE '
+    BEGIN {
+      numberMetrics = split (metrics, metric, "|")
+    }
+    NR > 1 {
+      for (m = 1; m <= numberMetrics; m++)
+        if ($2 == metric[m]) {
+          n[m] = $3
+          mean[m] = $4
+          halfWidth[m] = $6
+        }
+    }
+    END {
+      converged = 1
+      line = ""
+      for (m = 1; m <= numberMetrics; m++) {
+        if (n[m] == 1)
+          converged = 0
+        else if (n[m] > 1 && halfWidth[m] > tolerance * (mean[m] < 0 ? -mean[m] : mean[m]))
+          converged = 0
+        line = line "\t" metric[m] "\t" n[m] + 0 "\t" mean[m] + 0 "\t" halfWidth[m] + 0
+      }
+      print converged line
+    }'
+}
+
+
+# confidence intervals of the TARGET_METRICS of the seeds of a point.
+# Arguments: number of TCP users, method, factors, last seed
+intervals_of () {
+  if [ "$SHARDS" = "1" ]; then
+    FILES=$(shards_of $1 $2 $3 $4)
+    if [ -z "$FILES" ]; then
+      echo "" | merged_confidence_intervals
+    else
+      $MERGE_RESULTS $FILES | merged_confidence_intervals
+    fi
+  else
+    rows_of $1 $2 $3 $4 | confidence_intervals
+  fi
+}
+
+
+# confidence intervals of the TARGET_METRICS in the rows of a point (read from stdin)
+# The first word is 1 if all of them are narrower than TOLERANCE times the mean. Then, for each metric:
+# number of values, mean, half-width of the 95% confidence interval (Student's t). A metric without
+# values (e.g. there are no VoIP users) does not prevent stopping
+confidence_intervals () {
+  awk -F'\t' -v metrics="$TARGET_METRICS" -v tolerance=$TOLERANCE '
+    BEGIN {
+      numberMetrics = split (metrics, metric, "|")
+      # t of Student for 95%, two-sided, 1 to 30 degrees of freedom
+      split ("12.706 4.303 3.182 2.776 2.571 2.447 2.365 2.306 2.262 2.228 2.201 2.179 2.160 2.145 2.131 " \
+             "2.120 2.110 2.101 2.093 2.086 2.080 2.074 2.069 2.064 2.060 2.056 2.052 2.048 2.045 2.042", t, " ")
+    }
+    {
+      for (j = 2; j < NF; j += 2)
+        for (m = 1; m <= numberMetrics; m++)
+          if ($j == metric[m] && $(j+1) != "") {
+            n[m]++
+            sum[m] += $(j+1)
+            sumSquares[m] += $(j+1) * $(j+1)
+          }
+    }
+    END {
+      converged = 1
+      line = ""
+      for (m = 1; m <= numberMetrics; m++) {
+        mean = 0; halfWidth = 0
+        if (n[m] > 0)
+          mean = sum[m] / n[m]
+        if (n[m] > 1) {
+          variance = (sumSquares[m] - n[m] * mean * mean) / (n[m] - 1)
+          if (variance < 0)
+            variance = 0
+          halfWidth = (n[m] - 1 <= 30 ? t[n[m] - 1] : 1.960) * sqrt (variance / n[m])
+          if (halfWidth > tolerance * (mean < 0 ? -mean : mean))
+            converged = 0
+        }
+        else if (n[m] == 1)
+          converged = 0
+        line = line "\t" metric[m] "\t" n[m] + 0 "\t" mean "\t" halfWidth
+      }
+      print converged line
+    }'
+}
+
+
+# launch the grid
+declare -A LAST_SEED
+for i in $NUM_TCP_USERS_LIST; do
+  for method in $METHODS; do
+    for factors in $FACTORS_LIST; do
+      if [ "$SEQUENTIAL" = "1" ]; then
+        LAST_SEED["$i $method $factors"]=$(( INITSEED + MINSEEDS - 1 < MAXSEED ? INITSEED + MINSEEDS - 1 : MAXSEED ))
+      else
+        LAST_SEED["$i $method $factors"]=$MAXSEED
+      fi
+      launch_runs $i $method $factors $INITSEED ${LAST_SEED["$i $method $factors"]}
+    done
+  done
+done
+wait
+
+# sequential stopping: more seeds for the points that have not converged, until all of them converge or reach MAXSEED
+while [ "$SEQUENTIAL" = "1" ]; do
+  launched=0
+  for i in $NUM_TCP_USERS_LIST; do
+    for method in $METHODS; do
+      for factors in $FACTORS_LIST; do
+        last=${LAST_SEED["$i $method $factors"]}
+        if [ $last -ge $MAXSEED ]; then
+          continue
+        fi
+        converged=$(intervals_of $i $method $factors $last | cut -f1)
+        if [ "$converged" != "1" ]; then
+          next=$(( last + SEED_BATCH < MAXSEED ? last + SEED_BATCH : MAXSEED ))
+          echo "$INIT_FILE_NAME $(date) TcpDownUsers-$i method $method factors $factors has not converged with $(( last - INITSEED + 1 )) seeds. Adding seeds $(( last + 1 )) to $next"
+          launch_runs $i $method $factors $(( last + 1 )) $next
+          LAST_SEED["$i $method $factors"]=$next
+          launched=1
+        fi
+      done
+    done
+  done
+  wait
+  if [ $launched = 0 ]; then
+    break
+  fi
+done
+
+
+# one row per run, in the order of the grid (ordered by surname, if they come from the shards)
+rm -f ${INIT_FILE_NAME}_average.txt
+ALL_SHARDS=""
+for i in $NUM_TCP_USERS_LIST; do
+  for method in $METHODS; do
+    for factors in $FACTORS_LIST; do
+      for ((seed=INITSEED; seed<=${LAST_SEED["$i $method $factors"]}; seed++)); do
+        SURNAME=$(surname_of $i $method $factors $seed)
+        if [ "$SHARDS" = "1" ] && [ -f $RESULTS_FOLDER/$SURNAME.res ]; then
+          ALL_SHARDS="$ALL_SHARDS $RESULTS_FOLDER/$SURNAME.res"
+        elif [ "$SHARDS" != "1" ] && [ -f $RUNS_FOLDER/$SURNAME/${INIT_FILE_NAME}_average.txt ]; then
+          cat $RUNS_FOLDER/$SURNAME/${INIT_FILE_NAME}_average.txt >> ${INIT_FILE_NAME}_average.txt
+        else
+          echo "$SURNAME: no results" >&2
+        fi
+      done
+    done
+  done
+done
+
+# the shards are merged: the rows of '_average.txt', and the mean and confidence interval of each point
+if [ "$SHARDS" = "1" ] && [ -n "$ALL_SHARDS" ]; then
+  $MERGE_RESULTS -j $JOBS -l $ALL_SHARDS > ${INIT_FILE_NAME}_average.txt
+  $MERGE_RESULTS -j $JOBS $ALL_SHARDS > ${INIT_FILE_NAME}_summary.txt
+fi
+
+# seeds used by each point, and confidence intervals of the target metrics
+rm -f ${INIT_FILE_NAME}_seeds.txt
+for i in $NUM_TCP_USERS_LIST; do
+  for method in $METHODS; do
+    for factors in $FACTORS_LIST; do
+      last=${LAST_SEED["$i $method $factors"]}
+      POINT=$(surname_of $i $method $factors x)
+      echo -e "${POINT%_seed-x}\tseeds\t$(( last - INITSEED + 1 ))\tconverged\t$(intervals_of $i $method $factors $last)" >> ${INIT_FILE_NAME}_seeds.txt
+    done
+  done
+done
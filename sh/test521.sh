@@ -31,7 +31,7 @@ for ((i=INIT_NUM_TCP_USERS; i<=UPPER_LIMIT_NUM_TCP_USERS; i=$((${i}+${STEP_NUM_T
 
     echo "$INIT_FILE_NAME $(date) seed: $seed. number of TCP download users $NUMBER_TCP_USERS. number VoIP upload users $NUMBER_VOIP_USERS. Starting..."
 
-	executablename_string=${executablename_string}"scratch/wifi-central-controlled-aggregation_v199b11"
+	executablename_string=${executablename_string}"scratch/wifi-central-controlled-aggregation_v199b"
 
 	parameters_string=${parameters_string}" --simulationTime=60 \
         --numberVoIPupload=$NUMBER_VOIP_USERS \
@@ -87,7 +87,7 @@ for ((i=INIT_NUM_TCP_USERS; i<=UPPER_LIMIT_NUM_TCP_USERS; i=$((${i}+${STEP_NUM_T
         # Option F: dynamic algorithm
         parameters_string=${parameters_string}"--rateAPsWithAMPDUenabled=1.0 --aggregationDisableAlgorithm=0 \
 	--aggregationDynamicAlgorithm=1 --timeMonitorKPIs=0.25 --latencyBudget=0.004 \
-	--methodAdjustAmpdu=3 --stepAdjustAmpdu=3000 "
+	--methodAdjustAmpdu=3 --stepAdjustAmpdu=3000 --ampduGrowthFactor=1.618 --ampduShrinkFactor=0.618 "
 
 
 	# print the command that is to be run. Note that \" means the quotation mark character